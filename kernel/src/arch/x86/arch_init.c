@@ -29,6 +29,7 @@
 #include "driver/ramdisk.h"
 #include "kmalloc.h"
 #include "kprintf.h"
+#include "misc.h"
 #include <string.h>
 #include <stdint.h>
 
@@ -163,6 +164,36 @@ static void mod_load(const struct multiboot_info *mbi)
     ramdisk_init(addr, size); /* Initialize ramdisk device */
 }
 
+/* Fast system call entry point (isr_stub.S) */
+void sysenter_entry(void);
+
+/*
+ * Stack loaded by SYSENTER. The entry point immediately switches to the
+ * current task kernel stack, thus this is only used for a few instructions.
+ */
+static uint32_t sysenter_stack[16];
+
+/*
+ * Enable the SYSENTER/SYSEXIT fast system call instructions.
+ * Early Pentium Pro models (family 6, model < 3, stepping < 3) report
+ * the feature without supporting it. The same check is performed by
+ * the library before choosing the system call entry method.
+ */
+static void sysenter_init(void)
+{
+    uint32_t a, b, c, d;
+
+    cpuid(1, a, b, c, d);
+    if ((d & CPUID_EDX_SEP) == 0)
+        return;
+    if (((a >> 8) & 0xF) == 6 && ((a >> 4) & 0xF) < 3 && (a & 0xF) < 3)
+        return;
+
+    wrmsr(MSR_SYSENTER_CS, 0x08, 0);
+    wrmsr(MSR_SYSENTER_ESP, (uint32_t)&sysenter_stack[16], 0);
+    wrmsr(MSR_SYSENTER_EIP, (uint32_t)sysenter_entry, 0);
+}
+
 const struct multiboot_info *g_mbi;
 
 /*
@@ -184,6 +215,9 @@ void arch_init(const struct multiboot_info *mbi)
     /* Initialize global descriptor table */
     gdt_init();
 
+    /* Initialize fast system calls (needs the gdt layout) */
+    sysenter_init();
+
     /* Initialize interrupt descriptor table */
     idt_init();
 
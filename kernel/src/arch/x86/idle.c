@@ -18,7 +18,9 @@
  */
 
 #include "proc.h"
+#include "sys.h"
 #include "misc.h"
+#include <sys/wait.h>
 
 /*
  * Kernel idle procedure.
@@ -28,6 +30,8 @@
 void idle(void)
 {
     do {
+        /* Reap terminated kernel threads */
+        sys_waitpid(-1, NULL, WNOHANG);
         current->state = TASK_SLEEPING;
         scheduler();
         sti(); /* Enable interrupts */
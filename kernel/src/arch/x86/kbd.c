@@ -24,6 +24,7 @@
 #include "driver/tty.h"
 #include "proc.h"
 #include "sys.h"
+#include <string.h>
 
 /* Keyboard base address port. */
 #define KEYB_PORT               0x60
@@ -257,15 +258,12 @@ static unsigned int scan_key(void)
 
 static void kill_tty_group(void)
 {
-    struct task *t = current;
-    pid_t pgid;
+    siginfo_t info;
 
-    pgid = sys_tcgetpgrp(0);
-    do {
-        if (t->pgid == pgid)
-            task_signal(t, SIGINT);
-        t = list_container(t->tasks.next, struct task, tasks);
-    } while (t != current);
+    memset(&info, 0, sizeof(info));
+    info.si_signo = SIGINT;
+    info.si_code = SI_KERNEL;
+    pgrp_signal(sys_tcgetpgrp(0), &info);
 }
 
 /*
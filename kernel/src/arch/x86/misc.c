@@ -23,13 +23,22 @@
 
 
 void sigret_prepare(struct isr_frame *ifr,
-                    const struct sigaction *act, int sig)
+                    const struct sigaction *act, const siginfo_t *info)
 {
     uint32_t *esp;
+    siginfo_t *uinfo;
 
     /* Adjust user stack to return in the signal handler */
     esp = (uint32_t *)ifr->usr_esp;
-    *(--esp) = sig;
+    if ((act->sa_flags & SA_SIGINFO) != 0) {
+        /* Information copy and the handler extra arguments */
+        uinfo = (siginfo_t *)esp - 1;
+        *uinfo = *info;
+        esp = (uint32_t *)uinfo;
+        *(--esp) = 0;               /* context (unsupported) */
+        *(--esp) = (uint32_t)uinfo;
+    }
+    *(--esp) = info->si_signo;
     *(--esp) = (uint32_t)act->sa_restorer;
     ifr->usr_esp = (uint32_t)esp;
     ifr->eip = (uint32_t)act->sa_handler;
@@ -24,4 +24,47 @@
 #define cli() asm volatile("cli")
 #define hlt() asm volatile("hlt")
 
+/* Save the flags register and disable interrupts */
+#define irq_save(flags) \
+    asm volatile("pushf\n\tpop %0\n\tcli" : "=r"(flags) : : "memory")
+
+/* Restore the flags register, and thus the previous interrupts state */
+#define irq_restore(flags) \
+    asm volatile("push %0\n\tpopf" : : "r"(flags) : "memory", "cc")
+
+/* Let the pending interrupts be served (sti takes effect after nop) */
+#define irq_window() asm volatile("sti\n\tnop\n\tcli" : : : "memory")
+
+/* Compiler memory barrier */
+#define barrier() asm volatile("" : : : "memory")
+
+/* Index of the least significant set bit (undefined if val is zero) */
+static inline unsigned int bsf(unsigned long val)
+{
+    unsigned int pos;
+
+    asm("bsf %0, %1" : "=r"(pos) : "rm"(val) : "cc");
+    return pos;
+}
+
+/* Read the 64-bit time stamp counter */
+#define rdtsc(val) asm volatile("rdtsc" : "=A"(val))
+
+/* Processor identification */
+#define cpuid(leaf, a, b, c, d) \
+    asm volatile("cpuid" : "=a"(a), "=b"(b), "=c"(c), "=d"(d) : "a"(leaf))
+
+/* CPUID leaf 1 feature flags (edx) */
+#define CPUID_EDX_TSC   (1 << 4)    /* Time stamp counter */
+#define CPUID_EDX_SEP   (1 << 11)   /* SYSENTER/SYSEXIT instructions */
+
+/* Write a model specific register */
+#define wrmsr(msr, lo, hi) \
+    asm volatile("wrmsr" : : "c"(msr), "a"(lo), "d"(hi))
+
+/* Model specific registers */
+#define MSR_SYSENTER_CS     0x174   /* Kernel code segment selector */
+#define MSR_SYSENTER_ESP    0x175   /* Kernel stack pointer */
+#define MSR_SYSENTER_EIP    0x176   /* Kernel entry point */
+
 #endif /* BEEOS_ARCH_X86_MISC_H_ */
@@ -78,21 +78,14 @@
 
 
 /*
- * Maps a page virtual memory address to a physical memory address.
+ * Get the page table covering a virtual address, allocating it if required.
  */
-uint32_t page_map(void *virt, uint32_t phys)
+static uint32_t *page_tab_get(void *virt, uint32_t flags)
 {
     unsigned int di = DIR_INDEX(virt);
-    unsigned int ti = TAB_INDEX(virt);
     uint32_t tab_phys;
-    uint32_t pag_phys = phys;
     uint32_t *dir = (uint32_t *)PAGE_DIR_MAP;
     uint32_t *tab = (uint32_t *)(PAGE_TAB_MAP + (di * 0x1000));
-    uint32_t flags = PTE_P | PTE_W;
-
-    /* Check if is user space memory */
-    if ((uint32_t)virt < KVBASE)
-        flags |= PTE_U;
 
     /*
      * Check if the page table is present.
@@ -103,11 +96,31 @@ uint32_t page_map(void *virt, uint32_t phys)
         /* page table not present */
         tab_phys = (uint32_t)frame_alloc(0, ZONE_LOW);
         if (tab_phys == 0)
-            return (uint32_t)-ENOMEM;
+            return NULL;
         dir[di] = tab_phys | flags;
         /* Clean the new page table entries */
         memset(tab, 0, PAGE_SIZE);
     }
+    return tab;
+}
+
+/*
+ * Maps a page virtual memory address to a physical memory address.
+ */
+uint32_t page_map(void *virt, uint32_t phys)
+{
+    unsigned int ti = TAB_INDEX(virt);
+    uint32_t pag_phys = phys;
+    uint32_t *tab;
+    uint32_t flags = PTE_P | PTE_W;
+
+    /* Check if is user space memory */
+    if ((uint32_t)virt < KVBASE)
+        flags |= PTE_U;
+
+    tab = page_tab_get(virt, flags);
+    if (tab == NULL)
+        return (uint32_t)-ENOMEM;
 
     /*
      * Check if the virtual address is already mapped.
@@ -134,6 +147,28 @@ uint32_t page_map(void *virt, uint32_t phys)
     return pag_phys;
 }
 
+/*
+ * Maps a shared read-only page in the current process user space.
+ */
+int page_map_shared(void *virt, uint32_t phys)
+{
+    unsigned int ti = TAB_INDEX(virt);
+    uint32_t *tab;
+
+    if ((uint32_t)virt >= KVBASE)
+        return -EINVAL;
+
+    tab = page_tab_get(virt, PTE_P | PTE_W | PTE_U);
+    if (tab == NULL)
+        return -ENOMEM;
+    if ((tab[ti] & PTE_P) != 0)
+        panic("already mapped");
+    tab[ti] = (phys & PTE_MASK) | PTE_S | PTE_U | PTE_P;
+
+    flush_tlb();
+    return 0;
+}
+
 /*
  * Unmap a virtual memory address.
  */
@@ -150,6 +185,8 @@ uint32_t page_unmap(void *virt, int retain)
     if((dir[di] & PTE_P) != 0) {
         if ((tab[ti] & PTE_P) != 0) {
             pag_phys = (tab[ti] & PTE_MASK);
+            if ((tab[ti] & PTE_S) != 0)
+                retain = 1; /* Shared frames are owned by someone else */
             tab[ti] = 0;
             page_invalidate(pag_phys);
             if (retain == 0)
@@ -175,6 +212,8 @@ uint32_t page_unmap(void *virt, int retain)
 
 /*
  * Delete a page directory.
+ * Not preemptible: the temporary mapping slot (1022) belongs to the page
+ * directory, that may be shared with other threads.
  */
 void page_dir_del(uint32_t phys)
 {
@@ -183,6 +222,7 @@ void page_dir_del(uint32_t phys)
     const uint32_t *dir;
     uint32_t *dir_curr;
 
+    preempt_disable();
     dir_curr = (uint32_t *)PAGE_DIR_MAP;
     /* Temporary map the dir in under the current dir */
     dir_curr[1022] = phys | PTE_W | PTE_P;
@@ -195,7 +235,7 @@ void page_dir_del(uint32_t phys)
         if ((dir[di] & PTE_P) != 0) {
             tab = (uint32_t *)(PAGE_TAB_MAP2 + (di * 4096));
             for (ti = 0; ti < 1024; ti++) {
-                if ((tab[ti] & PTE_P) != 0)
+                if ((tab[ti] & (PTE_P | PTE_S)) == PTE_P)
                     frame_free((char *)(tab[ti] & PTE_MASK), 0);
             }
             frame_free((char *)(dir[di] & PTE_MASK), 0);
@@ -206,6 +246,7 @@ void page_dir_del(uint32_t phys)
     frame_free((char *)phys, 0);
     dir_curr[1022] = 0;
     flush_tlb();
+    preempt_enable();
 }
 
 
@@ -226,7 +267,10 @@ static void page_tab_dup(uint32_t *dir_dst, unsigned int i, uint32_t flags)
     dir_dst[i] = phys | flags;
 
     for (j = 0; j < 1024; j++) {
-        if (tab_src[j] != 0) {
+        if ((tab_src[j] & PTE_S) != 0) {
+            /* Shared pages are mapped as they are */
+            tab_dst[j] = tab_src[j];
+        } else if (tab_src[j] != 0) {
             /* TODO: copy on write (in the page fault handler) */
             /*
              * tab_src[j] &= ~PTE_W; // NON SEMBRA FUNZIONARE...
@@ -246,6 +290,7 @@ static void page_tab_dup(uint32_t *dir_dst, unsigned int i, uint32_t flags)
 
 /*
  * Duplicates the current process page directory.
+ * Not preemptible, as page_dir_del.
  */
 uint32_t page_dir_dup(int dup_user)
 {
@@ -255,6 +300,7 @@ uint32_t page_dir_dup(int dup_user)
     uint32_t phys;
     uint32_t flags = PTE_W | PTE_P;
 
+    preempt_disable();
     dir_src = (uint32_t *)PAGE_DIR_MAP;
     dir_dst = (uint32_t *)(PAGE_TAB_MAP + (1022 * 4096));
     phys = (uint32_t) frame_alloc(0, 0);
@@ -279,6 +325,7 @@ uint32_t page_dir_dup(int dup_user)
     phys = (dir_src[1022] & PTE_MASK);
     dir_src[1022] = 0;
     page_invalidate(phys);
+    preempt_enable();
     return phys;
 }
 
@@ -319,6 +366,22 @@ static void map_propagate(unsigned int idx)
 /* The fault was triggered by an instruction fetch (only if NX bit is enabled)*/
 #define ERR_FETCH   (1 << 4)
 
+/*
+ * The kernel wrote to a shared read-only user page on behalf of the process
+ * (e.g. the time page passed as a read() buffer). The faulting instruction
+ * can't be made to fail, thus the page is replaced by a private zeroed page
+ * that takes the write.
+ */
+static void page_shared_fault(uint32_t virt)
+{
+    char *page = (char *)ALIGN_DOWN(virt, PAGE_SIZE);
+
+    page_unmap(page, 0);
+    if ((int)page_map(page, (uint32_t)-1) < 0)
+        panic("Map page error");
+    memset(page, 0, PAGE_SIZE);
+}
+
 /*
  * Page fault interrupt handler.
  * Here, after some conditions checking, we try to resolve the fault
@@ -341,6 +404,7 @@ static void page_fault_handler(void)
 
     fault_addr_get(virt);
     err = current->arch.ifr->err_no;
+    current->acct.minflt++;
 
 #ifdef DEBUG_PAGING
     kprintf("pid: %d\n", current->pid);
@@ -368,6 +432,20 @@ static void page_fault_handler(void)
             do_kill = 1;
     }
 
+    if ((err & (ERR_USER | ERR_PRESENT)) == (ERR_USER | ERR_PRESENT)) {
+        /* User access violation on a mapped page (e.g. shared read-only) */
+        sys_kill(current->pid, SIGSEGV);
+        return;
+    }
+
+    if ((err & (ERR_USER | ERR_PRESENT | ERR_WRITE)) ==
+            (ERR_PRESENT | ERR_WRITE) && virt < KVBASE) {
+        /* Kernel write to a read-only user page, not a COW candidate */
+        page_shared_fault(virt);
+        sys_kill(current->pid, SIGSEGV);
+        return;
+    }
+
     phys = (uint32_t)frame_alloc(0, 0);
     if (phys == 0)
         panic("Out of mem in page fault handler");
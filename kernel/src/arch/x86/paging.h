@@ -51,6 +51,17 @@ void page_dir_del(uint32_t phys);
  */
 uint32_t page_map(void *virt, uint32_t phys);
 
+/**
+ * Maps a shared read-only page in the current process user space.
+ * Shared pages are neither copied when the address space is duplicated
+ * nor released when the address space is deleted.
+ *
+ * @param virt  Page user virtual memory address.
+ * @param phys  Page physical memory address.
+ * @return      0 on success, a negative error code otherwise.
+ */
+int page_map_shared(void *virt, uint32_t phys);
+
 /**
  * Unmaps a virtual memory address.
  *
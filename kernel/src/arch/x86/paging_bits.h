@@ -52,6 +52,7 @@
 #define PTE_W           0x00000002      /* Writeable */
 #define PTE_U           0x00000004      /* User */
 #define PTE_PS          0x00000080      /* Page size, if set 4MB else 4KB */
+#define PTE_S           0x00000200      /* Shared, never copied or freed */
 #define PTE_MASK        0xFFFFF000      /* Page pysical address mask */
 
 #endif /* BEEOS_ARCH_X86_PAGING_BITS_H_ */
@@ -20,25 +20,103 @@
 #include "proc.h"
 #include "arch/x86/task.h"
 #include "paging.h"
+#include "vmem.h"
 #include "kmalloc.h"
+#include "mm/frame.h"
 #include <stddef.h>
+#include <sched.h>
+#include <errno.h>
 
 
+/* Number of freed kernel stacks kept ready for reuse */
+#define KSTACK_READY_MAX    8
+
 struct tss_struct tss;
 
 void swtch(struct context **old, struct context *new);
 
+/*
+ * Ready kernel stacks, linked through their first word.
+ * The stacks are single page frames (thus aligned to their size), the short
+ * list avoids to go through the frame allocator on fork and exit sequences.
+ */
+static void *kstack_ready;
+static unsigned int kstack_ready_count;
+
+
+static void *kstack_alloc(void)
+{
+    void *stack;
+
+    if (kstack_ready != NULL) {
+        stack = kstack_ready;
+        kstack_ready = *(void **)stack;
+        kstack_ready_count--;
+        return stack;
+    }
+    stack = frame_alloc(0, ZONE_LOW);
+    return (stack != NULL) ? phys_to_virt(stack) : NULL;
+}
+
+static void kstack_free(void *stack)
+{
+    if (kstack_ready_count < KSTACK_READY_MAX) {
+        *(void **)stack = kstack_ready;
+        kstack_ready = stack;
+        kstack_ready_count++;
+    } else {
+        frame_free(virt_to_phys(stack), 0);
+    }
+}
+
+
+/*
+ * Share the current task page directory.
+ * The users counter is allocated when the directory is shared the first
+ * time.
+ */
+static int pgdir_share(struct task_arch *tsk)
+{
+    struct task_arch *curr = &current->arch;
+
+    if (curr->pgref == NULL) {
+        curr->pgref = (unsigned int *)kmalloc(sizeof(unsigned int), 0);
+        if (curr->pgref == NULL)
+            return -ENOMEM;
+        *curr->pgref = 1;
+    }
+    (*curr->pgref)++;
+    tsk->pgref = curr->pgref;
+    tsk->pgdir = curr->pgdir;
+    return 0;
+}
+
+void task_arch_pgdir_put(struct task_arch *tsk)
+{
+    if (tsk->pgref != NULL) {
+        if (--(*tsk->pgref) != 0) {
+            tsk->pgref = NULL;
+            return;     /* Still used by someone else */
+        }
+        kfree(tsk->pgref, sizeof(unsigned int));
+        tsk->pgref = NULL;
+    }
+    page_dir_del(tsk->pgdir);
+}
 
 /*
  * TODO : implement as clone syscall
  */
-int task_arch_init(struct task_arch *tsk, task_entry_t entry)
+int task_arch_init(struct task_arch *tsk, task_entry_t entry,
+                   unsigned int flags)
 {
     char *ti;
     uint32_t *sp;
+    int ret;
 
     tsk->ifr = NULL;
     tsk->sfr = NULL;
+    tsk->pgref = NULL;
 
     if (tsk == &ktask.arch) {
         /* The task 0 does not need complete initialization */
@@ -46,14 +124,23 @@ int task_arch_init(struct task_arch *tsk, task_entry_t entry)
         tsk->ctx = NULL;
     }
 
-    tsk->pgdir = page_dir_dup(1);
-    if ((int)tsk->pgdir < 0)
-        return (int)tsk->pgdir; /* Fail */
+    if ((flags & CLONE_VM) != 0) {
+        /* The address space is not copied at all */
+        ret = pgdir_share(tsk);
+        if (ret < 0)
+            return ret;
+    } else {
+        tsk->pgdir = page_dir_dup(1);
+        if ((int)tsk->pgdir < 0)
+            return (int)tsk->pgdir; /* Fail */
+    }
 
     /* Stack creation */
-    ti = (char *)kmalloc(KSTACK_SIZE, 0);
-    if (ti == NULL)
-        return -1;
+    ti = (char *)kstack_alloc();
+    if (ti == NULL) {
+        task_arch_pgdir_put(tsk);
+        return -ENOMEM;
+    }
 
     sp = (uint32_t *)ALIGN_DOWN((uintptr_t)ti + KSTACK_SIZE, sizeof(uint32_t));
 
@@ -76,16 +163,28 @@ int task_arch_init(struct task_arch *tsk, task_entry_t entry)
     return 0;
 }
 
+void task_arch_ustack(struct task_arch *tsk, uintptr_t sp)
+{
+    struct isr_frame *ifr;
+
+    /* The user frame copy is at the top of the kernel stack */
+    ifr = (struct isr_frame *)ALIGN_DOWN(ALIGN_UP((uintptr_t)tsk->ctx,
+                                         KSTACK_SIZE), sizeof(uint32_t)) - 1;
+    ifr->usr_esp = sp;
+}
+
 void task_arch_deinit(struct task_arch *tsk)
 {
-    kfree((void *)ALIGN_DOWN((uint32_t)tsk->ctx, KSTACK_SIZE), KSTACK_SIZE);
-    page_dir_del(tsk->pgdir);
+    kstack_free((void *)ALIGN_DOWN((uint32_t)tsk->ctx, KSTACK_SIZE));
+    task_arch_pgdir_put(tsk);
 }
 
 void task_arch_switch(struct task_arch *curr, const struct task_arch *next)
 {
     tss.esp0 = ALIGN_UP((uint32_t)next->ctx, KSTACK_SIZE);
-    page_dir_switch(next->pgdir);
+    /* Threads of the same process do not need a TLB flush */
+    if (next->pgdir != curr->pgdir)
+        page_dir_switch(next->pgdir);
 
     /* Execute this as the last statement. Can throw us in another place */
     swtch(&curr->ctx, next->ctx);
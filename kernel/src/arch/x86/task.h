@@ -91,6 +91,7 @@ struct context {
 
 struct task_arch {
     uint32_t            pgdir;  /**< Page directory physical address */
+    unsigned int        *pgref; /**< Shared page directory users (or NULL) */
     struct context      *ctx;   /**< Task state context */
     struct isr_frame    *ifr;   /**< Interrupt frame */
     struct isr_frame    *sfr;   /**< Interrupt saved frame (used by signals) */
@@ -21,6 +21,12 @@
 #include "timer.h"
 #include "io.h"
 #include "isr.h"
+#include "misc.h"
+#include "paging.h"
+#include "kmalloc.h"
+#include "panic.h"
+#include <sys/timepage.h>
+#include <string.h>
 
 /* Internal clock frequency is 1193180 Hz. */
 #define TIMER_ARCH_HZ       1193180 /* Built-in timer max frequency */
@@ -39,10 +45,103 @@
 #define TIMER_OPMODE        0x04    /* Mode 2, rate generator */
 #define TIMER_ACCESS        0x30    /* 16bit, LSB first */
 
+/* Channel 2 is gated via the keyboard controller port B */
+#define TIMER_IO_DAT2       0x42    /* Channel 2 data port */
+#define TIMER_IO_GATE       0x61    /* Channel 2 gate and output port */
+#define TIMER_GATE2         0x01    /* Channel 2 gate enable */
+#define TIMER_SPKR          0x02    /* Speaker data enable */
+#define TIMER_OUT2          0x20    /* Channel 2 output status */
+#define TIMER_CHAN2         0x80    /* Channel 2 select */
+#define TIMER_ONESHOT       0x00    /* Mode 0, interrupt on terminal count */
+
+/* Nanoseconds in one clock tick */
+#define TICK_NSECS          (1000000000L / CLOCKS_PER_SEC)
+/* Fixed point shift used for the TSC to nanoseconds conversion */
+#define TSC_SHIFT           22
+
+
+/* Time page, mapped read-only in every user process */
+static struct timepage *timepage;
+
+
+/*
+ * Measure the time stamp counter cycles within a clock tick.
+ * Channel 2 is programmed in one-shot mode with the tick divisor and its
+ * output is polled, thus this works with interrupts disabled.
+ */
+static uint32_t tsc_calibrate(void)
+{
+    uint64_t start, end;
+    uint8_t val;
+
+    val = inb(TIMER_IO_GATE) & ~TIMER_SPKR;
+    outb(TIMER_IO_GATE, val | TIMER_GATE2);
+
+    outb(TIMER_IO_CMD, TIMER_CHAN2 | TIMER_ACCESS | TIMER_ONESHOT);
+    outb(TIMER_IO_DAT2, (uint8_t)TIMER_DIVISOR);
+    outb(TIMER_IO_DAT2, (uint8_t)(TIMER_DIVISOR >> 8));
+
+    rdtsc(start);
+    while ((inb(TIMER_IO_GATE) & TIMER_OUT2) == 0)
+        ;
+    rdtsc(end);
+
+    outb(TIMER_IO_GATE, val & ~TIMER_GATE2);
+    return (uint32_t)(end - start);
+}
+
+static void timepage_init(void)
+{
+    uint32_t a, b, c, d;
+    uint32_t cycles;
+
+    timepage = (struct timepage *)kmalloc(PAGE_SIZE, 0);
+    if (timepage == NULL)
+        panic("Unable to allocate the time page");
+    memset(timepage, 0, PAGE_SIZE);
+
+    cpuid(1, a, b, c, d);
+    if ((d & CPUID_EDX_TSC) != 0) {
+        cycles = tsc_calibrate();
+        if (cycles != 0) {
+            timepage->tsc_mult = (uint32_t)
+                (((uint64_t)TICK_NSECS << TSC_SHIFT) / cycles);
+            timepage->tsc_shift = TSC_SHIFT;
+            rdtsc(timepage->tsc);
+        }
+    }
+    timepage->magic = TIMEPAGE_MAGIC;
+}
+
+int timepage_map(void)
+{
+    return page_map_shared((void *)TIMEPAGE_ADDR,
+                           (uint32_t)virt_to_phys(timepage));
+}
+
+void timepage_switch(clock_t usage)
+{
+    timepage->seq++;
+    barrier();
+    timepage->usage = usage;
+    timepage->switched = timer_ticks;
+    barrier();
+    timepage->seq++;
+}
 
 static void timer_handler(void)
 {
     timer_ticks++;
+
+    /* Interrupts are disabled, no need to protect the sequence counter */
+    timepage->seq++;
+    barrier();
+    timepage->ticks = timer_ticks;
+    if (timepage->tsc_mult != 0)
+        rdtsc(timepage->tsc);
+    barrier();
+    timepage->seq++;
+
     timer_update();
 }
 
@@ -60,6 +159,9 @@ void timer_arch_init(void)
     outb(TIMER_IO_DAT, lo);
     outb(TIMER_IO_DAT, hi);
 
+    /* Calibrate the TSC before the timer interrupts start */
+    timepage_init();
+
     /* register the timer callback */
     isr_register_handler(ISR_TIMER, timer_handler);
 }
@@ -23,83 +23,46 @@
 #include <string.h>
 
 
-#define BLOCK_SIZE  512
-
-
 static struct {
     void  *addr;
     size_t size;
 } ramdisk;
 
 
-static ssize_t ramdisk_rw_block(void *buf, size_t blocknum, int doread)
-{
-    size_t n = BLOCK_SIZE;
-    size_t off;
-
-    off = blocknum * BLOCK_SIZE;
-    if (off > ramdisk.size)
-        return -1;
-    if (off + n > ramdisk.size)
-        n = ramdisk.size - off;
-
-    if (doread == 1)
-        memcpy(buf, (char *)ramdisk.addr + off, n);
-    else
-        memcpy((char *)ramdisk.addr + off, buf, n);
-    return (ssize_t)n;
-}
-
-static ssize_t ramdisk_read_block(void *buf, size_t blocknum)
+/*
+ * Clamp a request to the device size.
+ * Returns the number of bytes that can be transferred.
+ */
+static size_t ramdisk_span(size_t size, size_t off)
 {
-    return ramdisk_rw_block(buf, blocknum, 1);
+    if (off >= ramdisk.size)
+        return 0;
+    return MIN(size, ramdisk.size - off);
 }
 
-#if 0
-static ssize_t ramdisk_write_block(void *buf, size_t blocknum)
+/*
+ * The image is resident in memory, thus any length and offset is served
+ * with a single copy, without splitting in sectors.
+ */
+ssize_t ramdisk_read(void *buf, size_t size, size_t off)
 {
-    return ramdisk_rw_block(buf, blocknum, 0);
+    size = ramdisk_span(size, off);
+    memcpy(buf, (char *)ramdisk.addr + off, size);
+    return (ssize_t)size;
 }
-#endif
-
-static char blk[BLOCK_SIZE];
 
-ssize_t ramdisk_read(void *buf, size_t size, size_t off)
+ssize_t ramdisk_write(const void *buf, size_t size, size_t off)
 {
-    unsigned int nblk;
-    size_t left;
-    size_t ioff;
-    ssize_t n;
-    char *ptr;
-
-    left = size;
-    nblk = off / BLOCK_SIZE;
-    ioff = off % BLOCK_SIZE;
-    ptr = (char *)buf;
-
-    if ((n = ramdisk_read_block(blk, nblk)) != BLOCK_SIZE)
-        return n;
-    n = MIN(BLOCK_SIZE - ioff, left);
-    memcpy(ptr, &blk[ioff], n);
-    left -= n;
-    ptr += n;
-    nblk++;
-    while (left > 0) {
-        if ((n = ramdisk_read_block(blk, nblk)) != BLOCK_SIZE)
-            break;
-        n = MIN(BLOCK_SIZE, left);
-        memcpy(ptr, blk, n);
-        left -= n;
-        ptr += n;
-        nblk++;
-    }
-
-    return (ssize_t)(size - left);
+    size = ramdisk_span(size, off);
+    memcpy((char *)ramdisk.addr + off, buf, size);
+    return (ssize_t)size;
 }
 
-ssize_t ramdisk_write(const void *buf, size_t size, size_t off)
+void *ramdisk_map(size_t size, size_t off)
 {
-    return -1; /* TODO */
+    if (ramdisk_span(size, off) != size)
+        return NULL;
+    return (char *)ramdisk.addr + off;
 }
 
 
@@ -29,5 +29,14 @@ ssize_t ramdisk_read(void *buf, size_t size, size_t off);
 
 ssize_t ramdisk_write(const void *buf, size_t size, size_t off);
 
+/**
+ * Get a direct pointer to the resident image.
+ *
+ * @param size  Size of the region.
+ * @param off   Region offset.
+ * @return      Region address or NULL if not within the device.
+ */
+void *ramdisk_map(size_t size, size_t off);
+
 
 #endif /* BEEOS_DRIVER_RAMDISK_H_ */
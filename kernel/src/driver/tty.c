@@ -127,12 +127,14 @@ static int tty_read_wait(dev_t dev, int couldblock)
 {
     struct tty_st *tty;
     int c = -1;
+    unsigned long flags;
 
     tty = tty_lookup(dev);
     if (tty == NULL)
         return -EINVAL;
 
-    spinlock_lock(&tty->rcond.lock);
+    /* Shared with the interrupt handler (tty_update) */
+    flags = spinlock_lock_irqsave(&tty->rcond.lock);
 
     while (tty->rpos >= tty->wpos && couldblock != 0) {
         tty->rpos = tty->wpos = 0;
@@ -142,7 +144,7 @@ static int tty_read_wait(dev_t dev, int couldblock)
     if (tty->rpos < tty->wpos)
         c = tty->rbuf[tty->rpos++];
 
-    spinlock_unlock(&tty->rcond.lock);
+    spinlock_unlock_irqrestore(&tty->rcond.lock, flags);
 
     return c;
 }
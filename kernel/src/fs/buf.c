@@ -0,0 +1,283 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "fs/buf.h"
+#include "fs/devfs/devfs.h"
+#include "proc/kthread.h"
+#include "mm/slab.h"
+#include "kmalloc.h"
+#include "kprintf.h"
+#include "util.h"
+#include <errno.h>
+
+#define BUF_MAX             128 /* Maximum number of cached blocks */
+#define BUF_HTABLE_BITS     6   /* 64 buckets hash table */
+
+#define KEY(dev, block)     (((uint64_t)(dev) << 32) | (block))
+
+static struct slab_cache buf_cache;
+static struct htable_link *buf_htable[1 << BUF_HTABLE_BITS];
+
+/* Unreferenced buffers, least recently used first */
+static struct list_link buf_lru;
+
+/* Dirty buffers write back work */
+static struct work buf_flush_work;
+
+static struct buf_stats stats;
+
+
+static struct buf *buf_lookup(dev_t dev, uint32_t block, size_t size)
+{
+    struct buf *b;
+    struct htable_link *lnk;
+
+    lnk = htable_lookup(buf_htable, KEY(dev, block), BUF_HTABLE_BITS);
+    while (lnk != NULL) {
+        b = struct_ptr(lnk, struct buf, hlink);
+        if (b->dev == dev && b->block == block && b->size == size)
+            return b;
+        lnk = lnk->next;
+    }
+    return NULL;
+}
+
+static ssize_t buf_io(const struct buf *b, int doread)
+{
+    size_t off = b->block * b->size;
+
+    if (doread)
+        return devfs_read(b->dev, b->data, b->size, off);
+    return devfs_write(b->dev, b->data, b->size, off);
+}
+
+/*
+ * Get an unused buffer, allocating a new one while below the cache limit
+ * or recycling the least recently used one.
+ */
+static struct buf *buf_get(void)
+{
+    struct buf *b;
+    struct list_link *lnk;
+
+    if (stats.bufs < BUF_MAX) {
+        b = (struct buf *)slab_cache_alloc(&buf_cache, 0);
+        if (b != NULL) {
+            b->data = NULL;
+            b->size = 0;
+            b->flags = 0;
+            stats.bufs++;
+            return b;
+        }
+    }
+
+    /* Dirty buffers that can't be written back are skipped */
+    for (lnk = buf_lru.next; lnk != &buf_lru; lnk = lnk->next) {
+        b = list_container(lnk, struct buf, lru);
+        if ((b->flags & BUF_DIRTY) == 0 || bwrite(b) == 0)
+            break;
+    }
+    if (lnk == &buf_lru)
+        return NULL;
+
+    list_delete(&b->lru);
+    if (b->hlink.pprev != NULL)
+        htable_delete(&b->hlink);
+    stats.evicts++;
+    return b;
+}
+
+/*
+ * Set up the buffer data. Blocks of memory resident devices are
+ * referenced in place, otherwise they are read into a private copy,
+ * reusing the previous one if of the same size. If the content is not
+ * read the buffer is left not valid.
+ */
+static int buf_fill(struct buf *b, size_t size, int doread)
+{
+    char *ptr;
+
+    ptr = (char *)devfs_map(b->dev, size, b->block * size);
+    if ((b->flags & BUF_MAPPED) == 0 && b->data != NULL &&
+        (ptr != NULL || b->size != size)) {
+        kfree(b->data, b->size);
+        b->data = NULL;
+    }
+    if (ptr != NULL) {
+        b->data = ptr;
+        b->size = size;
+        b->flags = BUF_VALID | BUF_MAPPED;
+        return 0;
+    }
+
+    if (b->data == NULL || (b->flags & BUF_MAPPED) != 0) {
+        b->flags = 0;
+        b->data = (char *)kmalloc(size, 0);
+        if (b->data == NULL)
+            return -ENOMEM;
+    }
+    b->size = size;
+    b->flags = 0;
+    if (doread) {
+        if (buf_io(b, 1) != (ssize_t)size)
+            return -EIO;
+        b->flags = BUF_VALID;
+    }
+    return 0;
+}
+
+/*
+ * Take a reference to a cached buffer.
+ */
+static struct buf *buf_hold(struct buf *b)
+{
+    stats.hits++;
+    if (b->ref++ == 0)
+        list_delete(&b->lru);
+    return b;
+}
+
+static struct buf *buf_new(dev_t dev, uint32_t block, size_t size, int doread)
+{
+    struct buf *b;
+    int res;
+
+    stats.misses++;
+    b = buf_get();
+    if (b == NULL)
+        return NULL;
+    b->dev = dev;
+    b->block = block;
+    b->ref = 1;
+    res = buf_fill(b, size, doread);
+    if (res < 0) {
+        /* Leave it unindexed at the head of the LRU for a prompt reuse */
+        b->hlink.pprev = NULL;
+        b->ref = 0;
+        list_insert_after(&buf_lru, &b->lru);
+        return NULL;
+    }
+    htable_insert(buf_htable, &b->hlink, KEY(dev, block), BUF_HTABLE_BITS);
+    return b;
+}
+
+struct buf *bread(dev_t dev, uint32_t block, size_t size)
+{
+    struct buf *b;
+
+    b = buf_lookup(dev, block, size);
+    if (b == NULL)
+        return buf_new(dev, block, size, 1);
+    buf_hold(b);
+    if ((b->flags & BUF_VALID) == 0) {
+        if (buf_io(b, 1) != (ssize_t)size) {
+            brelse(b);
+            return NULL;
+        }
+        b->flags |= BUF_VALID;
+    }
+    return b;
+}
+
+struct buf *bget(dev_t dev, uint32_t block, size_t size)
+{
+    struct buf *b;
+
+    b = buf_lookup(dev, block, size);
+    if (b == NULL)
+        return buf_new(dev, block, size, 0);
+    return buf_hold(b);
+}
+
+struct buf *blookup(dev_t dev, uint32_t block, size_t size)
+{
+    struct buf *b;
+
+    b = buf_lookup(dev, block, size);
+    if (b == NULL || (b->flags & BUF_VALID) == 0)
+        return NULL;
+    return buf_hold(b);
+}
+
+void brelse(struct buf *b)
+{
+    if (--b->ref == 0)
+        list_insert_before(&buf_lru, &b->lru);
+}
+
+void bdirty(struct buf *b)
+{
+    b->flags |= BUF_DIRTY;
+    work_schedule(&buf_flush_work);
+}
+
+int bwrite(struct buf *b)
+{
+    /* Mapped buffers are modified in place */
+    if ((b->flags & BUF_MAPPED) == 0 && buf_io(b, 0) != (ssize_t)b->size)
+        return -EIO;
+    b->flags &= ~BUF_DIRTY;
+    stats.writes++;
+    return 0;
+}
+
+int bsync(dev_t dev)
+{
+    int i, res = 0;
+    struct buf *b;
+    struct htable_link *lnk;
+
+    for (i = 0; i < (1 << BUF_HTABLE_BITS); i++) {
+        for (lnk = buf_htable[i]; lnk != NULL; lnk = lnk->next) {
+            b = struct_ptr(lnk, struct buf, hlink);
+            if ((b->flags & BUF_DIRTY) == 0 || (dev != NODEV && b->dev != dev))
+                continue;
+            if (bwrite(b) < 0)
+                res = -EIO;
+        }
+    }
+    return res;
+}
+
+static void buf_flush(void *arg)
+{
+    bsync(NODEV);
+}
+
+void buf_stats_get(struct buf_stats *st)
+{
+    *st = stats;
+}
+
+void buf_dump(void)
+{
+    kprintf("buffers: %u, hits: %u, misses: %u, evicts: %u, writes: %u\n",
+            (unsigned int)stats.bufs, (unsigned int)stats.hits,
+            (unsigned int)stats.misses, (unsigned int)stats.evicts,
+            (unsigned int)stats.writes);
+}
+
+void buf_init(void)
+{
+    slab_cache_init(&buf_cache, "buf-cache", sizeof(struct buf),
+            0, 0, NULL, NULL);
+    htable_init(buf_htable, BUF_HTABLE_BITS);
+    list_init(&buf_lru);
+    work_init(&buf_flush_work, buf_flush, NULL);
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Block buffer cache.
+ *
+ * Sits between the filesystems and the block device drivers. Buffers are
+ * indexed by (device, block number) through a hash table and the ones not
+ * referenced are kept in a LRU list, the least recently used is recycled
+ * when the cache is full. Dirty buffers are written back by the deferred
+ * work queue or on demand via bsync. Blocks of devices resident in memory
+ * are referenced in place rather than copied.
+ */
+
+#ifndef BEEOS_FS_BUF_H_
+#define BEEOS_FS_BUF_H_
+
+#include "htable.h"
+#include "list.h"
+#include <sys/types.h>
+#include <stdint.h>
+
+/** Any device, for bsync */
+#define NODEV       ((dev_t)-1)
+
+/** Buffer flags @{ */
+#define BUF_VALID   0x01    /**< Data has been read from the device */
+#define BUF_DIRTY   0x02    /**< Data has to be written to the device */
+#define BUF_MAPPED  0x04    /**< Data references the device memory */
+/** @} */
+
+/** Block buffer. */
+struct buf {
+    struct htable_link  hlink;  /**< Hash table link */
+    struct list_link    lru;    /**< LRU list link (when unreferenced) */
+    dev_t               dev;    /**< Block device */
+    uint32_t            block;  /**< Block number */
+    size_t              size;   /**< Block size */
+    int                 ref;    /**< References count */
+    int                 flags;  /**< Buffer flags */
+    char                *data;  /**< Block data */
+};
+
+/** Buffer cache statistics. */
+struct buf_stats {
+    unsigned long   bufs;       /**< Allocated buffers */
+    unsigned long   hits;       /**< Lookups satisfied by the cache */
+    unsigned long   misses;     /**< Lookups requiring a device read */
+    unsigned long   evicts;     /**< Recycled buffers */
+    unsigned long   writes;     /**< Blocks written back */
+};
+
+/**
+ * Get a referenced buffer holding the content of a device block.
+ * The same device is expected to be always accessed with the same block
+ * size.
+ *
+ * @param dev   Block device.
+ * @param block Block number (in size units).
+ * @param size  Block size.
+ * @return      Buffer or NULL on I/O error or if the cache is exhausted.
+ */
+struct buf *bread(dev_t dev, uint32_t block, size_t size);
+
+/**
+ * Get a referenced buffer for a device block without reading it.
+ * If the block is not cached the buffer is not valid: the caller is
+ * expected to fully overwrite the content and set BUF_VALID.
+ *
+ * @param dev   Block device.
+ * @param block Block number (in size units).
+ * @param size  Block size.
+ * @return      Buffer or NULL if the cache is exhausted.
+ */
+struct buf *bget(dev_t dev, uint32_t block, size_t size);
+
+/**
+ * Get a referenced buffer only if the block is cached, without any I/O.
+ *
+ * @param dev   Block device.
+ * @param block Block number (in size units).
+ * @param size  Block size.
+ * @return      Valid buffer or NULL if not cached.
+ */
+struct buf *blookup(dev_t dev, uint32_t block, size_t size);
+
+/**
+ * Release a buffer obtained via bread, bget or blookup.
+ *
+ * @param b     Buffer.
+ */
+void brelse(struct buf *b);
+
+/**
+ * Mark a buffer as modified and schedule its write back.
+ *
+ * @param b     Referenced buffer.
+ */
+void bdirty(struct buf *b);
+
+/**
+ * Synchronously write a buffer to the device.
+ *
+ * @param b     Referenced buffer.
+ * @return      0 on success, a negative error number on failure.
+ */
+int bwrite(struct buf *b);
+
+/**
+ * Write back all the dirty buffers of a device.
+ *
+ * @param dev   Block device, NODEV for all the devices.
+ * @return      0 on success, a negative error number if any write failed.
+ */
+int bsync(dev_t dev);
+
+/**
+ * Get the buffer cache statistics.
+ *
+ * @param st    Statistics destination.
+ */
+void buf_stats_get(struct buf_stats *st);
+
+/**
+ * Buffer cache dump function.
+ */
+void buf_dump(void);
+
+/**
+ * Initialize the buffer cache.
+ */
+void buf_init(void);
+
+#endif /* BEEOS_FS_BUF_H_ */
@@ -160,7 +160,22 @@ static dev_t name_to_dev(const char *name)
     return dev;
 }
 
-static int devfs_mknod(struct inode *idir, mode_t mode, dev_t dev)
+static const char *dev_to_name(dev_t dev)
+{
+    int i;
+    const char *name = NULL;
+
+    for (i = 0; i < NDEVS; i++) {
+        if (dev_name_map[i].dev == dev) {
+            name = dev_name_map[i].name;
+            break;
+        }
+    }
+    return name;
+}
+
+static int devfs_mknod(struct inode *idir, const char *name, mode_t mode,
+                       dev_t dev)
 {
     struct inode *inod;
     int res = -1;
@@ -169,6 +184,8 @@ static int devfs_mknod(struct inode *idir, mode_t mode, dev_t dev)
     if (inod != NULL) {
         if (S_ISBLK(mode) || S_ISCHR(mode))
             inod->rdev = dev;
+        /* Device nodes live as long as the system, not as their dentries */
+        inod->ref = 1;
         res = 0;
     }
     return res;
@@ -269,34 +286,55 @@ ssize_t devfs_write(dev_t dev, const void *buf, size_t size, size_t off)
     return n;
 }
 
+void *devfs_map(dev_t dev, size_t size, size_t off)
+{
+    void *ptr = NULL;
+
+    if (dev == DEV_INITRD)
+        ptr = ramdisk_map(size, off);
+    return ptr;
+}
+
 
-static int devfs_dentry_readdir(struct dentry *dir, unsigned int i,
-                                struct dirent *dent)
+/*
+ * The directory cursor is the entry index, "." and ".." come first.
+ * Entries are the device nodes, not the cached dentries that may have
+ * been reclaimed.
+ */
+static int devfs_dentry_readdir(struct dentry *dir, size_t *pos,
+                                struct dirent *dents, size_t count)
 {
-    static const struct list_link *rd_curr_link;
-    int res = -1;
-    const char *name = NULL;
-    const struct dentry *curr;
-
-    if (i == 0) {
-        name = ".";
-    } else if (i == 1) {
-        name = "..";
-    } else {
-        if (i == 2)
-            rd_curr_link = dir->child.next;
-        if (rd_curr_link != &dir->child) {
-            curr = list_container(rd_curr_link, struct dentry, link);
-            name = curr->name;
-            rd_curr_link = rd_curr_link->next;
-            dent->d_ino = curr->inod->ino;
+    size_t i = 0, n = 0;
+    const char *name;
+    ino_t ino;
+    const struct list_link *curr_link = devfs_nodes.next;
+    const struct devfs_inode *curr;
+
+    while (n < count) {
+        if (i < 2) {
+            name = (i == 0) ? "." : "..";
+            ino = dir->inod->ino;
+        } else {
+            name = NULL;
+            while (name == NULL && curr_link != &devfs_nodes) {
+                curr = list_container(curr_link, struct devfs_inode, link);
+                name = dev_to_name(curr->base.rdev);
+                ino = curr->base.ino;
+                curr_link = curr_link->next;
+            }
+            if (name == NULL)
+                break;
         }
+        if (i >= *pos) {
+            strncpy(dents[n].d_name, name, sizeof(dents[n].d_name));
+            dents[n].d_ino = ino;
+            n++;
+        }
+        i++;
     }
-    if (name != NULL) {
-        strncpy(dent->d_name, name, sizeof(dent->d_name));
-        res = 0;
-    }
-    return res;
+    if (n > 0)
+        *pos = i;
+    return n;
 }
 
 static const struct dentry_ops devfs_dentry_ops = {
@@ -29,6 +29,17 @@ ssize_t devfs_read(dev_t dev, void *buf, size_t size, size_t off);
 
 ssize_t devfs_write(dev_t dev, const void *buf, size_t size, size_t off);
 
+/**
+ * Get a direct pointer to a block device region, if the device content
+ * is resident in memory.
+ *
+ * @param dev   Block device.
+ * @param size  Size of the region.
+ * @param off   Region offset.
+ * @return      Region address or NULL if not supported.
+ */
+void *devfs_map(dev_t dev, size_t size, size_t off);
+
 struct super_block *devfs_sb_get(void);
 
 
@@ -0,0 +1,285 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Ext2 blocks and inodes allocation.
+ *
+ * Bitmaps, group descriptors and superblock counters are updated in the
+ * buffer cache and written back with the other dirty buffers.
+ * Blocks are allocated in contiguous runs, to let the files grow by
+ * preallocated windows.
+ */
+
+#include "ext2_fs.h"
+#include "fs/buf.h"
+#include "util.h"
+#include "arch/x86/misc.h"
+#include <stdint.h>
+#include <string.h>
+
+/* Free run length searched for multiple blocks allocations */
+#define BITMAP_RUN_WANT     16
+
+
+/* Write the free counters to the on disk superblock */
+static void ext2_super_sync(const struct ext2_super_block *sb)
+{
+    struct buf *bp;
+    struct ext2_disk_super_block *dsb;
+
+    bp = bread(sb->base.dev, 1024 >> (10 + sb->log_block_size),
+               sb->block_size);
+    if (bp == NULL)
+        return;
+    dsb = (struct ext2_disk_super_block *)
+          (bp->data + (1024 & (sb->block_size - 1)));
+    dsb->free_blocks_count = sb->free_blocks_count;
+    dsb->free_inodes_count = sb->free_inodes_count;
+    bdirty(bp);
+    brelse(bp);
+}
+
+/* Write a group descriptor to the on disk table */
+static void ext2_gd_sync(const struct ext2_super_block *sb, unsigned int group)
+{
+    struct buf *bp;
+    unsigned int per_block;
+
+    per_block = sb->block_size / sizeof(struct ext2_group_desc);
+    bp = bread(sb->base.dev, sb->gd_first + group / per_block, sb->block_size);
+    if (bp == NULL)
+        return;
+    memcpy(bp->data + (group % per_block) * sizeof(struct ext2_group_desc),
+           &sb->gd_table[group], sizeof(struct ext2_group_desc));
+    bdirty(bp);
+    brelse(bp);
+}
+
+/*
+ * Find the first clear bit within [from, to).
+ * The bitmap is scanned a 32-bit word at a time, full words are skipped.
+ * Returns the bit index or -1 if none.
+ */
+static int bitmap_find(const uint8_t *map, unsigned int from, unsigned int to)
+{
+    const uint32_t *words = (const uint32_t *)map;
+    unsigned int i = from;
+    uint32_t w;
+
+    while (i < to) {
+        /* Bits below i are considered in use */
+        w = words[i >> 5] | ((1U << (i & 31)) - 1);
+        if (w != 0xFFFFFFFF) {
+            i = (i & ~31U) + bsf(~w);
+            return (i < to) ? (int)i : -1;
+        }
+        i = (i | 31) + 1;
+    }
+    return -1;
+}
+
+/*
+ * Length of the clear bits run starting at bit, up to the to bit.
+ * Whole clear words are counted at once.
+ */
+static unsigned int bitmap_run(const uint8_t *map, unsigned int bit,
+                               unsigned int to)
+{
+    const uint32_t *words = (const uint32_t *)map;
+    unsigned int i = bit;
+
+    while (i < to) {
+        if ((i & 31) == 0 && i + 32 <= to && words[i >> 5] == 0) {
+            i += 32;
+            continue;
+        }
+        if ((map[i >> 3] & (1 << (i & 7))) != 0)
+            break;
+        i++;
+    }
+    return i - bit;
+}
+
+/*
+ * Allocate up to count contiguous bits within [from, nbits) of a group
+ * bitmap. The goal bit is taken if free, otherwise the first run long
+ * enough (up to BITMAP_RUN_WANT) after it, otherwise the first free bit,
+ * wrapping around.
+ * Returns the first bit index, or -1 if the bitmap is full, and the
+ * number of allocated bits via got.
+ */
+static int bitmap_alloc(const struct ext2_super_block *sb, uint32_t block,
+                        unsigned int from, unsigned int goal,
+                        unsigned int nbits, unsigned int count,
+                        unsigned int *got)
+{
+    struct buf *bp;
+    uint8_t *map;
+    unsigned int j, len, want;
+    int i;
+
+    bp = bread(sb->base.dev, block, sb->block_size);
+    if (bp == NULL)
+        return -1;
+    map = (uint8_t *)bp->data;
+
+    i = bitmap_find(map, goal, nbits);
+    if (i >= 0 && (unsigned int)i != goal && count > 1) {
+        want = MIN(count, BITMAP_RUN_WANT);
+        for (j = i; j < nbits; j += len + 1) {
+            j = bitmap_find(map, j, nbits);
+            if ((int)j < 0)
+                break;
+            len = bitmap_run(map, j, MIN(j + want, nbits));
+            if (len >= want) {
+                i = j;
+                break;
+            }
+        }
+    }
+    if (i < 0 && goal > from)
+        i = bitmap_find(map, from, goal);
+
+    if (i >= 0) {
+        *got = bitmap_run(map, i, MIN(i + count, nbits));
+        for (j = i; j < i + *got; j++)
+            map[j >> 3] |= 1 << (j & 7);
+        bdirty(bp);
+    }
+    brelse(bp);
+    return i;
+}
+
+static void bitmap_free(const struct ext2_super_block *sb, uint32_t block,
+                        unsigned int bit)
+{
+    struct buf *bp;
+
+    bp = bread(sb->base.dev, block, sb->block_size);
+    if (bp == NULL)
+        return;
+    bp->data[bit >> 3] &= ~(1 << (bit & 7));
+    bdirty(bp);
+    brelse(bp);
+}
+
+
+uint32_t ext2_balloc(struct ext2_super_block *sb, uint32_t goal,
+                     unsigned int count, unsigned int *got)
+{
+    unsigned int n, group, bit, nbits;
+    struct ext2_group_desc *gd;
+    int i;
+
+    if (goal < sb->first_data_block || goal >= sb->blocks_count)
+        goal = sb->first_data_block;
+    group = (goal - sb->first_data_block) / sb->blocks_per_group;
+    bit = (goal - sb->first_data_block) % sb->blocks_per_group;
+
+    for (n = 0; n < sb->groups_count; n++) {
+        gd = &sb->gd_table[group];
+        if (gd->free_blocks_count != 0) {
+            /* The last group may be smaller */
+            nbits = MIN(sb->blocks_per_group, sb->blocks_count -
+                        sb->first_data_block - group * sb->blocks_per_group);
+            i = bitmap_alloc(sb, gd->block_bitmap, 0, bit, nbits,
+                             count, got);
+            if (i >= 0) {
+                gd->free_blocks_count -= *got;
+                sb->free_blocks_count -= *got;
+                ext2_gd_sync(sb, group);
+                ext2_super_sync(sb);
+                return sb->first_data_block + group * sb->blocks_per_group + i;
+            }
+        }
+        group = (group + 1) % sb->groups_count;
+        bit = 0;
+    }
+    return 0;
+}
+
+void ext2_bfree(struct ext2_super_block *sb, uint32_t block)
+{
+    unsigned int group;
+
+    if (block < sb->first_data_block || block >= sb->blocks_count)
+        return;
+    block -= sb->first_data_block;
+    group = block / sb->blocks_per_group;
+    bitmap_free(sb, sb->gd_table[group].block_bitmap,
+                block % sb->blocks_per_group);
+    sb->gd_table[group].free_blocks_count++;
+    sb->free_blocks_count++;
+    ext2_gd_sync(sb, group);
+    ext2_super_sync(sb);
+}
+
+ino_t ext2_ialloc(struct ext2_super_block *sb, ino_t dir, int isdir)
+{
+    unsigned int n, group, best, goal, got;
+    struct ext2_group_desc *gd;
+    int i;
+
+    group = (dir - 1) / sb->inodes_per_group;
+    if (isdir) {
+        /* Spread directories, to leave room for their files */
+        for (best = group, n = 0; n < sb->groups_count; n++) {
+            if (sb->gd_table[n].free_inodes_count >
+                sb->gd_table[best].free_inodes_count)
+                best = n;
+        }
+        group = best;
+    }
+
+    for (n = 0; n < sb->groups_count; n++) {
+        gd = &sb->gd_table[group];
+        if (gd->free_inodes_count != 0) {
+            /* Skip the reserved inodes */
+            goal = (group == 0) ? sb->first_ino - 1 : 0;
+            i = bitmap_alloc(sb, gd->inode_bitmap, goal, goal,
+                             sb->inodes_per_group, 1, &got);
+            if (i >= 0) {
+                gd->free_inodes_count--;
+                if (isdir)
+                    gd->used_dirs_count++;
+                sb->free_inodes_count--;
+                ext2_gd_sync(sb, group);
+                ext2_super_sync(sb);
+                return group * sb->inodes_per_group + i + 1;
+            }
+        }
+        group = (group + 1) % sb->groups_count;
+    }
+    return 0;
+}
+
+void ext2_ifree(struct ext2_super_block *sb, ino_t ino, int isdir)
+{
+    unsigned int group;
+
+    group = (ino - 1) / sb->inodes_per_group;
+    bitmap_free(sb, sb->gd_table[group].inode_bitmap,
+                (ino - 1) % sb->inodes_per_group);
+    sb->gd_table[group].free_inodes_count++;
+    if (isdir)
+        sb->gd_table[group].used_dirs_count--;
+    sb->free_inodes_count++;
+    ext2_gd_sync(sb, group);
+    ext2_super_sync(sb);
+}
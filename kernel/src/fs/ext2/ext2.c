@@ -18,246 +18,1056 @@
  */
 
 #include "ext2.h"
+#include "ext2_fs.h"
 #include "fs/vfs.h"
 #include "fs/devfs/devfs.h"
+#include "fs/buf.h"
+#include "fs/pcache.h"
 #include "kmalloc.h"
 #include "dev.h"
+#include "proc.h"
 #include "util.h"
 #include "panic.h"
+#include "arch/x86/paging_bits.h"
 #include <errno.h>
 #include <string.h>
 #include <stdint.h>
 
+#define EXT2_PREALLOC_MIN   8   /* Regular files preallocation window */
+#define EXT2_PREALLOC_MAX   64  /* Maximum preallocation window */
 
-#define EXT2_MAGIC          0xef53
-#define EXT2_NDIR_BLOCKS    12  /* Number of direct blocks */
-#define EXT2_BLK_IND        12  /* Indirect blocks index */
-#define EXT2_BLK_DBL        13  /* Double indirect blocks index */
-#define EXT2_BLK_TPL        14  /* Triple indirect blocks index */
+
+static int ext2_super_inode_write(struct inode *inod);
 
 /*
- * Unused macros reserved for future extensions or completeness.
+ * Read the block holding an on disk inode.
+ * On success the inode location within the buffer is returned via dinodp.
  */
+static struct buf *ext2_inode_buf(const struct ext2_super_block *sb, ino_t ino,
+                                  struct ext2_disk_inode **dinodp)
+{
+    const struct ext2_group_desc *gd;
+    uint32_t off;
+    struct buf *bp;
+
+    gd = &sb->gd_table[(ino - 1) / sb->inodes_per_group];
+    off = ((ino - 1) % sb->inodes_per_group) * sb->inode_size;
+    bp = bread(sb->base.dev, gd->inode_table + off / sb->block_size,
+               sb->block_size);
+    if (bp != NULL)
+        *dinodp = (struct ext2_disk_inode *)
+                  (bp->data + (off & (sb->block_size - 1)));
+    return bp;
+}
 
-#define EXT2_BAD_INO            1
-#define EXT2_ROOT_INO           2
-#define EXT2_ACL_IDX_INO        3
-#define EXT2_ACL_DATA_INO       4
-#define EXT2_BOOT_LOADER_INO    5
-#define EXT2_UNDEL_DIR_INO      6
-
-
-struct ext2_disk_super_block {
-    uint32_t inodes_count;      /* Count of inodes in fs */
-    uint32_t blocks_count;      /* Count of blocks in fs */
-    uint32_t r_blocks_count;    /* Count of # of reserved blocks */
-    uint32_t free_blocks_count; /* Count of # of free blocksw */
-    uint32_t free_inodes_count; /* Count of # of free inodes */
-    uint32_t first_data_block;  /* First block that contains data */
-    uint32_t log_block_size;    /* Indicator of block size */
-    int32_t  log_frag_size;     /* Indicator of the size of fragments */
-    uint32_t blocks_per_group;  /* Count of # of blocks in each block group */
-    uint32_t frags_per_group;   /* Count of # of fragments in each block group */
-    uint32_t inodes_per_group;  /* Count of # of inodes in each blcok group */
-    uint32_t mtime;             /* time filesystem was last mounted */
-    uint32_t wtime;             /* time filesystem was last written to */
-    uint16_t mnt_count;         /* number of times the fs has been mounted */
-    int16_t  max_mnt_count;     /* number of times the fs can be mounted */
-    uint16_t magic;             /* EXT2 Magic number */
-    uint16_t state;             /* flags indicating current state of fs */
-    uint16_t errors;            /* flags indicating errors */
-    uint16_t pad;               /* padding */
-    uint32_t lastcheck;         /* time the fs was last checked */
-    uint32_t checkinterval;     /* maximum time between checks */
-    uint32_t creator_os;        /* indicator of which OS created */
-    uint32_t rev_level;         /* EXT2 revision level */
-    uint32_t reserved[236];     /* padding to 1024 bytesOS */
-};
 
-struct ext2_group_desc {
-    uint32_t block_bitmap;  /* address of block containing the block bitmap for this group */
-    uint32_t inode_bitmap;  /* address of block containing the inode bitmap for this group */
-    uint32_t inode_table;   /* address of the block containing the inode table for this group */
-    uint16_t free_blocks_count; /* count of free blocks in group */
-    uint16_t free_inodes_count; /* count of free inodes in group */
-    uint16_t used_dirs_count;   /* number of inodes in this group that are directories */
-    uint16_t pad;
-    uint32_t reserved[3];
-};
-
-struct ext2_disk_inode {
-    uint16_t mode;          /* File mode */
-    uint16_t uid;           /* Owner UID */
-    uint32_t size;          /* size in bytes */
-    uint32_t atime;         /* access time */
-    uint32_t ctime;         /* creation time */
-    uint32_t mtime;         /* modification time */
-    uint32_t dtime;         /* deletion time */
-    uint16_t gid;           /* Group ID */
-    uint16_t links_count;   /* links count */
-    uint32_t blocks;        /* blocks count */
-    uint32_t flags;         /* file flags */
-    uint32_t reserved1;
-    uint32_t block[15];     /* pointers to blocks */
-    uint32_t version;
-    uint32_t file_acl;      /* file ACL */
-    uint32_t dir_acl;       /* directory acl */
-    uint8_t  faddr;         /* fragment address */
-    uint8_t  fsize;         /* fragment size */
-    uint16_t pad1;
-    uint32_t reserved2[3];
-};
+/******************************************************************************
+ *  Blocks mapping
+ ******************************************************************************/
 
-struct ext2_disk_dirent {
-    uint32_t ino;
-    uint16_t rec_len;
-    uint8_t  name_len;
-    uint8_t  file_type;
-    char     name[255];
-};
+/*
+ * Allocate a block for a file from its preallocation window. When the
+ * window is empty a new one is allocated close to the last block of the
+ * file or, for the first one, at the start of the inode group. Its size
+ * follows the blocks expected to be written soon (pa_hint), thus data
+ * written back in large batches gets contiguous blocks.
+ * Indirect blocks are zeroed via the buffer cache.
+ *
+ * @return  Block number or 0 on failure.
+ */
+static uint32_t ext2_block_new(struct ext2_inode *inod, int zero)
+{
+    struct ext2_super_block *sb = (struct ext2_super_block *)inod->base.sb;
+    uint32_t goal, block;
+    unsigned int want, got;
+    struct buf *bp;
+
+    if (inod->pa_count == 0) {
+        goal = inod->goal;
+        if (goal == 0)
+            goal = sb->first_data_block + sb->blocks_per_group *
+                   ((inod->base.ino - 1) / sb->inodes_per_group);
+        want = S_ISREG(inod->base.mode) ? EXT2_PREALLOC_MIN : 1;
+        want = MIN(MAX(want, inod->pa_hint), EXT2_PREALLOC_MAX);
+        inod->pa_start = ext2_balloc(sb, goal, want, &got);
+        if (inod->pa_start == 0)
+            return 0;
+        inod->pa_count = got;
+    }
+    block = inod->pa_start++;
+    inod->pa_count--;
+    if (inod->pa_hint != 0)
+        inod->pa_hint--;
+
+    if (zero != 0) {
+        bp = bget(sb->base.dev, block, sb->block_size);
+        if (bp == NULL) {
+            ext2_bfree(sb, block);
+            return 0;
+        }
+        memset(bp->data, 0, sb->block_size);
+        bp->flags |= BUF_VALID;
+        bdirty(bp);
+        brelse(bp);
+    }
+    inod->goal = block + 1;
+    inod->sectors += sb->block_size >> 9;
+    return block;
+}
 
-struct ext2_super_block {
-    struct super_block      base;
-    uint32_t                block_size;
-    uint32_t                inodes_per_group;
-    uint32_t                log_block_size;
-    struct ext2_group_desc *gd_table;
-};
+/* Give back the unused preallocated blocks */
+static void ext2_prealloc_release(struct ext2_inode *inod)
+{
+    struct ext2_super_block *sb = (struct ext2_super_block *)inod->base.sb;
 
-struct ext2_inode {
-    struct inode base;
-    uint32_t blocks[15]; /* pointers to blocks */
-};
+    for (; inod->pa_count != 0; inod->pa_count--)
+        ext2_bfree(sb, inod->pa_start++);
+}
 
+static void ext2_block_release(struct ext2_inode *inod, uint32_t block)
+{
+    struct ext2_super_block *sb = (struct ext2_super_block *)inod->base.sb;
 
+    ext2_bfree(sb, block);
+    inod->sectors -= sb->block_size >> 9;
+}
 
-static int offset_to_block(size_t offset, const struct ext2_inode *inod,
-                           const struct ext2_super_block *sb)
+/*
+ * Map a file logical block to the device block, walking the indirect
+ * blocks tree. A copy of the last used leaf indirect block is kept in the
+ * inode, thus sequential accesses don't walk the tree at every block.
+ * If create is set the missing blocks are allocated, the caller is in
+ * charge to write back the inode.
+ *
+ * @return  Device block number, 0 for a hole or a negative error number.
+ */
+static int ext2_bmap(struct ext2_inode *inod, uint32_t lblk, int create)
 {
-    uint32_t triple_block, double_block, indirect_block, block;
-    uint8_t ind, dbl, tpl;
-    uint32_t *buf;
-    uint32_t shift;
-
-    shift = 10 + sb->log_block_size;
-    if (shift >= 8 * sizeof(size_t))
-        return -1;
+    const struct ext2_super_block *sb;
+    uint32_t bits, mask, block, idx, *slot, *ptrs;
+    struct buf *bp;
+    int depth, i;
+
+    if (lblk < EXT2_NDIR_BLOCKS) {
+        slot = &inod->blocks[lblk];
+        if (*slot == 0 && create != 0) {
+            *slot = ext2_block_new(inod, 0);
+            if (*slot == 0)
+                return -ENOSPC;
+        }
+        return *slot;
+    }
 
-    /* Is direct? */
-    if (offset < EXT2_NDIR_BLOCKS * sb->block_size) {
-        ind = offset >> shift;
-        if (ind >= sizeof(inod->blocks)/sizeof(inod->blocks[0]))
-            return -1;
-        return inod->blocks[ind];
+    sb = (struct ext2_super_block *)inod->base.sb;
+    bits = sb->log_block_size + 8; /* Block pointers per block (log2) */
+    mask = (1 << bits) - 1;
+
+    lblk -= EXT2_NDIR_BLOCKS;
+    if (lblk < (1U << bits)) {
+        depth = 1;
+    } else if (lblk - (1U << bits) < (1U << 2 * bits)) {
+        lblk -= 1U << bits;
+        depth = 2;
+    } else {
+        lblk -= (1U << bits) + (1U << 2 * bits);
+        if (3 * bits < 32 && lblk >= (1U << 3 * bits))
+            return -EFBIG;
+        depth = 3;
     }
+    slot = &inod->blocks[EXT2_BLK_IND + depth - 1];
 
-    buf = (uint32_t *)kmalloc(sb->block_size, 0);
+    if (inod->map_depth == depth && inod->map_index == (lblk >> bits) &&
+        (create == 0 || inod->map[lblk & mask] != 0))
+        return inod->map[lblk & mask];
 
-    indirect_block = inod->blocks[EXT2_BLK_IND];
-    double_block = inod->blocks[EXT2_BLK_DBL];
-    triple_block = inod->blocks[EXT2_BLK_TPL];
+    if (*slot == 0 && create != 0) {
+        *slot = ext2_block_new(inod, 1);
+        if (*slot == 0)
+            return -ENOSPC;
+    }
+    block = *slot;
+
+    for (i = depth - 1; i >= 0 && block != 0; i--) {
+        bp = bread(sb->base.dev, block, sb->block_size);
+        if (bp == NULL)
+            return -EIO;
+        ptrs = (uint32_t *)bp->data;
+        idx = (lblk >> (i * bits)) & mask;
+        if (ptrs[idx] == 0 && create != 0) {
+            ptrs[idx] = ext2_block_new(inod, i != 0);
+            if (ptrs[idx] == 0) {
+                brelse(bp);
+                return -ENOSPC;
+            }
+            bdirty(bp);
+        }
+        if (i == 0) {
+            if (inod->map == NULL)
+                inod->map = (uint32_t *)kmalloc(sb->block_size, 0);
+            if (inod->map != NULL) {
+                memcpy(inod->map, bp->data, sb->block_size);
+                inod->map_depth = depth;
+                inod->map_index = lblk >> bits;
+            }
+        }
+        block = ptrs[idx];
+        brelse(bp);
+    }
+    return block;
+}
 
-    offset = (offset >> shift) - EXT2_NDIR_BLOCKS;
-    ind = offset;
-    dbl = offset >> 8;
-    tpl = offset >> 16;
+/*
+ * Release the blocks referenced by an indirect block slot, starting from
+ * the given index within the subtree. The indirect block itself is
+ * released if the whole subtree goes away.
+ */
+static void ext2_trunc_tree(struct ext2_inode *inod, uint32_t *slot,
+                            int depth, uint32_t from)
+{
+    const struct ext2_super_block *sb;
+    uint32_t bits, shift, first, i, *ptrs;
+    struct buf *bp;
 
-    if (tpl != 0)
-        panic("ext2: required triple block %d", triple_block);
+    if (*slot == 0)
+        return;
+    sb = (struct ext2_super_block *)inod->base.sb;
+    bits = sb->log_block_size + 8;
+    shift = (depth - 1) * bits;
+
+    bp = bread(sb->base.dev, *slot, sb->block_size);
+    if (bp == NULL)
+        return;
+    ptrs = (uint32_t *)bp->data;
+    first = from >> shift;
+    for (i = first; i < (1U << bits); i++) {
+        if (ptrs[i] == 0)
+            continue;
+        if (depth == 1) {
+            ext2_block_release(inod, ptrs[i]);
+            ptrs[i] = 0;
+        } else {
+            ext2_trunc_tree(inod, &ptrs[i], depth - 1,
+                            (i == first) ? from & ((1U << shift) - 1) : 0);
+        }
+    }
+    bdirty(bp);
+    brelse(bp);
 
-    if (dbl != 0)
-        panic("ext2: required double block %d", double_block);
+    if (from == 0) {
+        ext2_block_release(inod, *slot);
+        *slot = 0;
+    }
+}
 
-    if (devfs_read(sb->base.dev, buf, sb->block_size,
-                   indirect_block*sb->block_size) != sb->block_size)
-        return -1;
-    block = buf[ind];
+/*
+ * Release all the file blocks from the given logical block onwards.
+ */
+static void ext2_trunc_blocks(struct ext2_inode *inod, uint32_t first)
+{
+    const struct ext2_super_block *sb;
+    uint32_t bits, base, span;
+    int depth;
 
-    kfree(buf, sb->block_size);
+    sb = (struct ext2_super_block *)inod->base.sb;
+    bits = sb->log_block_size + 8;
 
-    return block;
+    for (base = first; base < EXT2_NDIR_BLOCKS; base++) {
+        if (inod->blocks[base] != 0) {
+            ext2_block_release(inod, inod->blocks[base]);
+            inod->blocks[base] = 0;
+        }
+    }
+    base = EXT2_NDIR_BLOCKS;
+    for (depth = 1; depth <= 3; depth++) {
+        span = (depth * bits < 32) ? 1U << (depth * bits) : 0xFFFFFFFF;
+        if (first < base + span)
+            ext2_trunc_tree(inod, &inod->blocks[EXT2_BLK_IND + depth - 1],
+                            depth, (first > base) ? first - base : 0);
+        base += span;
+    }
+    inod->map_depth = 0;
 }
 
+
 /******************************************************************************
- *  Dentry operations
+ *  Inode operations
  ******************************************************************************/
 
+/*
+ * Fill a page cache page with the file content, reading the data blocks
+ * directly from the device: they are cached by the page cache.
+ * Physically contiguous blocks are read with a single device request.
+ * Blocks present in the buffer cache are taken from there, they may not
+ * have been written back yet.
+ */
+static int ext2_readpage(struct inode *inod, void *data, uint32_t index)
+{
+    const struct ext2_super_block *sb;
+    size_t i, n, pos, block_off, dev_off;
+    size_t run_off = 0, run_len = 0;
+    char *run_buf = NULL;
+    struct buf *bp;
+    int block;
+
+    sb = (struct ext2_super_block *)inod->sb;
+    for (i = 0; i < PAGE_SIZE; i += n) {
+        pos = index * PAGE_SIZE + i;
+        if (pos >= inod->size) {
+            memset((char *)data + i, 0, PAGE_SIZE - i);
+            break;
+        }
+        block_off = pos & (sb->block_size - 1);
+        n = MIN(sb->block_size - block_off, PAGE_SIZE - i);
+        block = ext2_bmap((struct ext2_inode *)inod,
+                          pos >> (10 + sb->log_block_size), 0);
+        if (block < 0)
+            return -EIO;
+        dev_off = block * sb->block_size + block_off;
+        bp = (block != 0) ? blookup(sb->base.dev, block, sb->block_size) :
+                            NULL;
+
+        /* Issue the pending run if this block doesn't extend it */
+        if (run_len != 0 &&
+            (block == 0 || bp != NULL || dev_off != run_off + run_len)) {
+            if (devfs_read(sb->base.dev, run_buf, run_len, run_off) !=
+                run_len) {
+                if (bp != NULL)
+                    brelse(bp);
+                return -EIO;
+            }
+            run_len = 0;
+        }
+        if (bp != NULL) {
+            memcpy((char *)data + i, bp->data + block_off, n);
+            brelse(bp);
+        } else if (block == 0) {
+            /* File hole */
+            memset((char *)data + i, 0, n);
+        } else {
+            if (run_len == 0) {
+                run_buf = (char *)data + i;
+                run_off = dev_off;
+            }
+            run_len += n;
+        }
+    }
+    if (run_len != 0 &&
+        devfs_read(sb->base.dev, run_buf, run_len, run_off) != run_len)
+        return -EIO;
+    return 0;
+}
+
 static ssize_t ext2_read(struct ext2_inode *inod, void *buf,
                          size_t count, size_t off)
+{
+    return pcache_read(&inod->base, buf, count, off, ext2_readpage);
+}
+
+/*
+ * Copy the blocks touched by a page update into the buffer cache, where
+ * they are written back with the other dirty buffers. Missing blocks are
+ * allocated.
+ */
+static int ext2_writepage(struct ext2_inode *inod, const struct cpage *pg,
+                          size_t from, size_t len)
 {
     const struct ext2_super_block *sb;
-    int left;
+    struct buf *bp;
+    size_t off;
     int block;
-    size_t ext2_off, block_off, file_off;
-    ssize_t n;
 
     sb = (struct ext2_super_block *)inod->base.sb;
+    for (off = from & ~(sb->block_size - 1); off < from + len;
+         off += sb->block_size) {
+        block = ext2_bmap(inod, (pg->index * PAGE_SIZE + off) >>
+                          (10 + sb->log_block_size), 1);
+        if (block < 0)
+            return block;
+        bp = bget(sb->base.dev, block, sb->block_size);
+        if (bp == NULL)
+            return -EIO;
+        memcpy(bp->data, pg->data + off, sb->block_size);
+        bp->flags |= BUF_VALID;
+        bdirty(bp);
+        brelse(bp);
+    }
+    return 0;
+}
+
+/*
+ * Count the unallocated blocks within a page.
+ */
+static unsigned int ext2_page_holes(struct ext2_inode *inod, uint32_t index)
+{
+    const struct ext2_super_block *sb;
+    uint32_t lblk, last;
+    unsigned int n = 0;
 
-    if (inod->base.size < off)
-        return 0; /* EOF */
-    if (inod->base.size < off + count)
-        count = inod->base.size - off;
+    sb = (struct ext2_super_block *)inod->base.sb;
+    lblk = (index * PAGE_SIZE) >> (10 + sb->log_block_size);
+    last = lblk + (PAGE_SIZE >> (10 + sb->log_block_size));
+    for (; lblk < last; lblk++) {
+        if (ext2_bmap(inod, lblk, 0) <= 0)
+            n++;
+    }
+    return n;
+}
 
-    file_off = off;
-    left = count;
-    while (left > 0) {
-        block = offset_to_block(file_off, inod, sb);
-        if (block < 0)
+/*
+ * Data is written to the page cache only, blocks are allocated when the
+ * dirty pages are written back (delayed allocation). The blocks needed
+ * by the page holes are reserved when a page gets dirty, thus the write
+ * back doesn't run out of space.
+ */
+static ssize_t ext2_write(struct ext2_inode *inod, const void *buf,
+                          size_t count, size_t off)
+{
+    struct ext2_super_block *sb;
+    struct cpage *pg;
+    size_t i, n, pg_off;
+    unsigned int holes;
+    int res = 0;
+
+    sb = (struct ext2_super_block *)inod->base.sb;
+    if (!S_ISREG(inod->base.mode) || sb->block_size > PAGE_SIZE)
+        return -EINVAL;
+
+    for (i = 0; i < count; i += n) {
+        pg_off = (off + i) & (PAGE_SIZE - 1);
+        n = MIN(count - i, PAGE_SIZE - pg_off);
+        pg = pcache_get(&inod->base, (off + i) / PAGE_SIZE, ext2_readpage);
+        if (pg == NULL) {
+            res = -EIO;
+            break;
+        }
+        if ((pg->flags & CPAGE_DIRTY) == 0) {
+            holes = ext2_page_holes(inod, pg->index);
+            if (sb->dalloc + holes > sb->free_blocks_count + inod->pa_count) {
+                pcache_put(pg);
+                res = -ENOSPC;
+                break;
+            }
+            sb->dalloc += holes;
+            inod->dalloc += holes;
+            pcache_dirty(pg);
+        }
+        memcpy(pg->data + pg_off, (const char *)buf + i, n);
+        if (off + i + n > inod->base.size)
+            inod->base.size = off + i + n;
+        pcache_put(pg);
+    }
+    return (i != 0) ? (ssize_t)i : res;
+}
+
+/* Drop the blocks reservation of the inode dirty pages */
+static void ext2_dalloc_release(struct ext2_inode *inod)
+{
+    ((struct ext2_super_block *)inod->base.sb)->dalloc -= inod->dalloc;
+    inod->dalloc = 0;
+}
+
+/* Lowest index dirty page of an inode */
+static struct cpage *ext2_first_dirty(struct inode *inod)
+{
+    struct list_link *curr;
+    struct cpage *pg, *first = NULL;
+
+    for (curr = inod->pages.next; curr != &inod->pages; curr = curr->next) {
+        pg = list_container(curr, struct cpage, ilink);
+        if ((pg->flags & CPAGE_DIRTY) != 0 &&
+            (first == NULL || pg->index < first->index))
+            first = pg;
+    }
+    return first;
+}
+
+/*
+ * Write back the dirty pages, allocating their blocks.
+ * Runs of consecutive dirty pages are processed together: the run length
+ * is used as preallocation hint, thus the run gets contiguous blocks.
+ * Dirty pages are never recycled by the page cache, thus no reference
+ * is taken here.
+ * Pages failing to be written back (e.g. no space left for the indirect
+ * blocks, which are not reserved) are marked with an error instead of
+ * being retried forever. The error is returned by the next sync request.
+ */
+static int ext2_writeback(struct inode *inod, int sync)
+{
+    struct ext2_inode *ext2_inod = (struct ext2_inode *)inod;
+    const struct ext2_super_block *sb;
+    struct cpage *pg, *next;
+    uint32_t index, pages;
+    size_t len;
+    int res;
+
+    /* Unlinked inode being freed, the data goes away with it */
+    if (ext2_inod->links == 0 && inod->ref == 0) {
+        pcache_invalidate(inod);
+        ext2_dalloc_release(ext2_inod);
+        return 0;
+    }
+    pg = ext2_first_dirty(inod);
+    if (pg == NULL && (sync == 0 || ext2_inod->pa_count == 0)) {
+        res = ext2_inod->wb_error;
+        if (sync != 0)
+            ext2_inod->wb_error = 0;
+        return res;
+    }
+
+    sb = (struct ext2_super_block *)inod->sb;
+    for (; pg != NULL; pg = ext2_first_dirty(inod)) {
+        for (pages = 1; ; pages++) {
+            next = pcache_find(inod, pg->index + pages);
+            if (next == NULL || (next->flags & CPAGE_DIRTY) == 0)
+                break;
+        }
+        ext2_inod->pa_hint = pages * (PAGE_SIZE >> (10 + sb->log_block_size));
+        for (index = pg->index; index < pg->index + pages; index++) {
+            next = pcache_find(inod, index);
+            /* Nothing to write beyond the end of file */
+            if (index * PAGE_SIZE < inod->size) {
+                len = MIN(PAGE_SIZE, inod->size - index * PAGE_SIZE);
+                res = ext2_writepage(ext2_inod, next, 0, len);
+                if (res < 0) {
+                    ext2_inod->wb_error = res;
+                    pcache_error(next);
+                    continue;
+                }
+            }
+            pcache_clean(next);
+        }
+    }
+    ext2_inod->pa_hint = 0;
+    ext2_dalloc_release(ext2_inod);
+    if (sync != 0)
+        ext2_prealloc_release(ext2_inod);
+    if (ext2_super_inode_write(inod) < 0)
+        ext2_inod->wb_error = -EIO;
+    res = ext2_inod->wb_error;
+    if (sync != 0)
+        ext2_inod->wb_error = 0;
+    return res;
+}
+
+static int ext2_truncate(struct inode *inod, size_t size)
+{
+    struct ext2_inode *ext2_inod = (struct ext2_inode *)inod;
+    const struct ext2_super_block *sb;
+    size_t tail;
+    struct buf *bp;
+    int block;
+
+    if (!S_ISREG(inod->mode))
+        return -EINVAL;
+    sb = (struct ext2_super_block *)inod->sb;
+    if (size < inod->size) {
+        /* Cached pages are dropped, write back the surviving data */
+        ext2_writeback(inod, 1);
+        ext2_trunc_blocks(ext2_inod, (size + sb->block_size - 1) >>
+                          (10 + sb->log_block_size));
+        /* The last block tail is read back as zeros if the file grows */
+        tail = size & (sb->block_size - 1);
+        if (tail != 0) {
+            block = ext2_bmap(ext2_inod, size >> (10 + sb->log_block_size),
+                              0);
+            bp = (block > 0) ? bread(sb->base.dev, block, sb->block_size) :
+                               NULL;
+            if (bp != NULL) {
+                memset(bp->data + tail, 0, sb->block_size - tail);
+                bdirty(bp);
+                brelse(bp);
+            }
+        }
+        pcache_invalidate(inod);
+    }
+    inod->size = size;
+    return ext2_super_inode_write(inod);
+}
+
+
+/*
+ * Walk the directory entries until the callback returns a non zero value.
+ * Directory entries never span across blocks and the unused ones have a
+ * zero inode number.
+ *
+ * @return  The callback non zero result, 0 if the end is reached or a
+ *          negative error number on failure.
+ */
+static int ext2_dir_iterate(struct inode *dir,
+                            int (*fn)(const struct ext2_disk_dirent *, void *),
+                            void *arg)
+{
+    const struct ext2_super_block *sb;
+    const struct ext2_disk_dirent *curr;
+    struct buf *bp;
+    size_t off, blk_off;
+    int block, res = 0;
+
+    sb = (struct ext2_super_block *)dir->sb;
+    for (off = 0; off < dir->size && res == 0; off += sb->block_size) {
+        block = ext2_bmap((struct ext2_inode *)dir,
+                          off >> (10 + sb->log_block_size), 0);
+        if (block <= 0)
+            return -EIO;
+        bp = bread(sb->base.dev, block, sb->block_size);
+        if (bp == NULL)
+            return -EIO;
+        blk_off = 0;
+        while (blk_off + 8 <= sb->block_size && res == 0) {
+            curr = (struct ext2_disk_dirent *)(bp->data + blk_off);
+            if (curr->rec_len < 8)
+                break;
+            if (curr->ino != 0)
+                res = fn(curr, arg);
+            blk_off += curr->rec_len;
+        }
+        brelse(bp);
+    }
+    return res;
+}
+
+/*
+ * Find a directory entry by name.
+ * On success the buffer holding the entry is returned via bpp and has to
+ * be released by the caller. If prevp is not NULL it is set to the
+ * previous entry within the same block (NULL for the first one).
+ */
+static struct ext2_disk_dirent *ext2_dir_find(struct ext2_inode *dir,
+                                              const char *name,
+                                              struct buf **bpp,
+                                              struct ext2_disk_dirent **prevp)
+{
+    const struct ext2_super_block *sb;
+    struct ext2_disk_dirent *curr, *prev;
+    struct buf *bp;
+    size_t off, blk_off, len;
+    int block;
+
+    sb = (struct ext2_super_block *)dir->base.sb;
+    len = strlen(name);
+    for (off = 0; off < dir->base.size; off += sb->block_size) {
+        block = ext2_bmap(dir, off >> (10 + sb->log_block_size), 0);
+        if (block <= 0)
             break;
-        block_off = off % sb->block_size; /* used just by the first block */
-        ext2_off = block * sb->block_size + block_off;
-        n = MIN(left, sb->block_size - block_off);
-        if (devfs_read(sb->base.dev, buf, n, ext2_off) != n)
+        bp = bread(sb->base.dev, block, sb->block_size);
+        if (bp == NULL)
             break;
+        prev = NULL;
+        for (blk_off = 0; blk_off + 8 <= sb->block_size;
+             blk_off += curr->rec_len) {
+            curr = (struct ext2_disk_dirent *)(bp->data + blk_off);
+            if (curr->rec_len < 8)
+                break;
+            /* dirent->name is not null terminated */
+            if (curr->ino != 0 && curr->name_len == len &&
+                memcmp(curr->name, name, len) == 0) {
+                *bpp = bp;
+                if (prevp != NULL)
+                    *prevp = prev;
+                return curr;
+            }
+            prev = curr;
+        }
+        brelse(bp);
+    }
+    return NULL;
+}
 
-        left -= n;
-        file_off += n;
-        buf = (char *)buf + n;
-        off = 0;
+static uint8_t ext2_file_type(mode_t mode)
+{
+    switch (mode & S_IFMT) {
+    case S_IFREG:
+        return EXT2_FT_REG_FILE;
+    case S_IFDIR:
+        return EXT2_FT_DIR;
+    case S_IFCHR:
+        return EXT2_FT_CHRDEV;
+    case S_IFBLK:
+        return EXT2_FT_BLKDEV;
+    case S_IFIFO:
+        return EXT2_FT_FIFO;
+    case S_IFSOCK:
+        return EXT2_FT_SOCK;
+    case S_IFLNK:
+        return EXT2_FT_SYMLINK;
+    default:
+        return EXT2_FT_UNKNOWN;
     }
-    return count-left;
+}
+
+static void ext2_dirent_set(const struct ext2_super_block *sb,
+                            struct ext2_disk_dirent *dent, const char *name,
+                            ino_t ino, mode_t mode)
+{
+    dent->ino = ino;
+    dent->name_len = strlen(name);
+    dent->file_type = ((sb->feature_incompat &
+                        EXT2_FEATURE_INCOMPAT_FILETYPE) != 0) ?
+                      ext2_file_type(mode) : 0;
+    memcpy(dent->name, name, dent->name_len);
+}
+
+/*
+ * Add a directory entry, splitting the first entry with enough spare
+ * room or appending a new block to the directory.
+ */
+static int ext2_dir_add(struct ext2_inode *dir, const char *name,
+                        ino_t ino, mode_t mode)
+{
+    const struct ext2_super_block *sb;
+    struct ext2_disk_dirent *curr, *next;
+    struct buf *bp;
+    size_t off, blk_off, used, need;
+    int block;
+
+    sb = (struct ext2_super_block *)dir->base.sb;
+    need = EXT2_DIR_REC_LEN(strlen(name));
+    for (off = 0; off < dir->base.size; off += sb->block_size) {
+        block = ext2_bmap(dir, off >> (10 + sb->log_block_size), 0);
+        if (block <= 0)
+            return -EIO;
+        bp = bread(sb->base.dev, block, sb->block_size);
+        if (bp == NULL)
+            return -EIO;
+        for (blk_off = 0; blk_off + 8 <= sb->block_size;
+             blk_off += curr->rec_len) {
+            curr = (struct ext2_disk_dirent *)(bp->data + blk_off);
+            if (curr->rec_len < 8)
+                break;
+            used = (curr->ino != 0) ? EXT2_DIR_REC_LEN(curr->name_len) : 0;
+            if (curr->rec_len >= used + need) {
+                if (used != 0) {
+                    next = (struct ext2_disk_dirent *)((char *)curr + used);
+                    next->rec_len = curr->rec_len - used;
+                    curr->rec_len = used;
+                    curr = next;
+                }
+                ext2_dirent_set(sb, curr, name, ino, mode);
+                bdirty(bp);
+                brelse(bp);
+                return 0;
+            }
+        }
+        brelse(bp);
+    }
+
+    block = ext2_bmap(dir, dir->base.size >> (10 + sb->log_block_size), 1);
+    if (block < 0)
+        return block;
+    bp = bget(sb->base.dev, block, sb->block_size);
+    if (bp == NULL)
+        return -EIO;
+    memset(bp->data, 0, sb->block_size);
+    bp->flags |= BUF_VALID;
+    curr = (struct ext2_disk_dirent *)bp->data;
+    curr->rec_len = sb->block_size;
+    ext2_dirent_set(sb, curr, name, ino, mode);
+    bdirty(bp);
+    brelse(bp);
+    dir->base.size += sb->block_size;
+    return ext2_super_inode_write(&dir->base);
+}
+
+/*
+ * Remove an entry found via ext2_dir_find, merging its room into the
+ * previous entry. The buffer is not released.
+ */
+static void ext2_dir_del(struct buf *bp, struct ext2_disk_dirent *curr,
+                         struct ext2_disk_dirent *prev)
+{
+    if (prev != NULL)
+        prev->rec_len += curr->rec_len;
+    else
+        curr->ino = 0;
+    bdirty(bp);
+}
+
+static int ext2_dir_empty_cb(const struct ext2_disk_dirent *curr, void *arg)
+{
+    (void)arg;
+    return !(curr->name[0] == '.' && (curr->name_len == 1 ||
+             (curr->name_len == 2 && curr->name[1] == '.')));
+}
+
+static int ext2_dir_empty(struct ext2_inode *dir)
+{
+    return ext2_dir_iterate(&dir->base, ext2_dir_empty_cb, NULL) == 0;
 }
 
 static struct inode *ext2_lookup(struct inode *dir, const char *name)
 {
     struct ext2_disk_dirent *curr;
-    struct ext2_disk_dirent *dirbuf;
-    int count;
+    struct buf *bp;
+    ino_t ino;
     struct inode *inod = NULL;
 
-    dirbuf = (struct ext2_disk_dirent *)kmalloc(dir->size, 0);
-    if (dirbuf == NULL)
-        return NULL;
+    curr = ext2_dir_find((struct ext2_inode *)dir, name, &bp, NULL);
+    if (curr != NULL) {
+        ino = curr->ino;
+        brelse(bp);
+        inod = iget(dir->sb, ino);
+        if (inod != NULL)
+            inod->ref--; /* iget incremented the counter... release it */
+    }
+    return inod;
+}
 
-    if (devfs_read(dir->sb->dev, dirbuf, dir->size,
-                   ((struct ext2_inode *)dir)->blocks[0] * 1024) != dir->size)
-        goto end;
-
-    count = dir->size;
-    curr = dirbuf;
-    while(count >= sizeof(struct ext2_disk_dirent)) {
-        /* dirent->name is not null terminated */
-        if(strlen(name) == (size_t)curr->name_len &&
-           memcmp(name, curr->name, curr->name_len) == 0) {
-            inod = iget(dir->sb, curr->ino);
-            if (inod != NULL)
-                inod->ref--; /* iget incremented the counter... release it */
-            break;
+/*
+ * Allocate and initialize an on disk inode.
+ *
+ * @return  Inode number or a negative error number.
+ */
+static int ext2_inode_new(struct inode *dir, mode_t mode, dev_t dev)
+{
+    struct ext2_super_block *sb = (struct ext2_super_block *)dir->sb;
+    struct ext2_disk_inode *dinod;
+    struct buf *bp;
+    ino_t ino;
+
+    ino = ext2_ialloc(sb, dir->ino, S_ISDIR(mode));
+    if (ino == 0)
+        return -ENOSPC;
+    bp = ext2_inode_buf(sb, ino, &dinod);
+    if (bp == NULL) {
+        ext2_ifree(sb, ino, S_ISDIR(mode));
+        return -EIO;
+    }
+    memset(dinod, 0, sb->inode_size);
+    dinod->mode = mode;
+    dinod->uid = current->euid;
+    dinod->gid = current->egid;
+    dinod->links_count = S_ISDIR(mode) ? 2 : 1;
+    if (S_ISCHR(mode) || S_ISBLK(mode))
+        dinod->block[0] = dev;
+    bdirty(bp);
+    brelse(bp);
+    return ino;
+}
+
+/*
+ * Release the blocks and the on disk inode of a file without links.
+ * Called when the last reference goes away, thus the file stays usable
+ * through the descriptors still open after the last unlink.
+ * Device nodes and fast symbolic links have no allocated blocks.
+ */
+static void ext2_inode_release(struct ext2_inode *inod)
+{
+    struct ext2_super_block *sb = (struct ext2_super_block *)inod->base.sb;
+
+    pcache_invalidate(&inod->base);
+    ext2_dalloc_release(inod);
+    ext2_prealloc_release(inod);
+    if (inod->sectors != 0)
+        ext2_trunc_blocks(inod, 0);
+    inod->base.size = 0;
+    inod->links = 0;
+    ext2_super_inode_write(&inod->base);
+    ext2_ifree(sb, inod->base.ino, S_ISDIR(inod->base.mode));
+    inode_unhash(&inod->base);
+}
+
+static int ext2_mknod(struct inode *idir, const char *name, mode_t mode,
+                      dev_t dev)
+{
+    struct ext2_inode *dir = (struct ext2_inode *)idir;
+    struct buf *bp;
+    int ino, res;
+
+    if (ext2_dir_find(dir, name, &bp, NULL) != NULL) {
+        brelse(bp);
+        return -EEXIST;
+    }
+    if ((mode & S_IFMT) == 0)
+        mode |= S_IFREG;
+    else if (S_ISDIR(mode))
+        return -EINVAL;
+
+    ino = ext2_inode_new(idir, mode, dev);
+    if (ino < 0)
+        return ino;
+    res = ext2_dir_add(dir, name, ino, mode);
+    if (res < 0)
+        ext2_ifree((struct ext2_super_block *)idir->sb, ino, 0);
+    return res;
+}
+
+static int ext2_mkdir(struct inode *idir, const char *name, mode_t mode)
+{
+    struct ext2_inode *dir = (struct ext2_inode *)idir;
+    struct ext2_super_block *sb;
+    struct ext2_disk_dirent *dent;
+    struct ext2_inode *inod;
+    struct buf *bp;
+    int ino, block, res;
+
+    if (ext2_dir_find(dir, name, &bp, NULL) != NULL) {
+        brelse(bp);
+        return -EEXIST;
+    }
+    sb = (struct ext2_super_block *)idir->sb;
+    mode = S_IFDIR | (mode & 07777);
+    ino = ext2_inode_new(idir, mode, 0);
+    if (ino < 0)
+        return ino;
+    inod = (struct ext2_inode *)iget(idir->sb, ino);
+    if (inod == NULL) {
+        ext2_ifree(sb, ino, 1);
+        return -ENOMEM;
+    }
+
+    block = ext2_bmap(inod, 0, 1);
+    bp = (block > 0) ? bget(sb->base.dev, block, sb->block_size) : NULL;
+    if (bp != NULL) {
+        memset(bp->data, 0, sb->block_size);
+        bp->flags |= BUF_VALID;
+        dent = (struct ext2_disk_dirent *)bp->data;
+        dent->rec_len = EXT2_DIR_REC_LEN(1);
+        ext2_dirent_set(sb, dent, ".", ino, mode);
+        dent = (struct ext2_disk_dirent *)(bp->data + dent->rec_len);
+        dent->rec_len = sb->block_size - EXT2_DIR_REC_LEN(1);
+        ext2_dirent_set(sb, dent, "..", idir->ino, S_IFDIR);
+        bdirty(bp);
+        brelse(bp);
+        inod->base.size = sb->block_size;
+        res = ext2_super_inode_write(&inod->base);
+    } else {
+        res = (block < 0) ? block : -EIO;
+    }
+
+    if (res == 0)
+        res = ext2_dir_add(dir, name, ino, mode);
+    if (res == 0) {
+        dir->links++;
+        res = ext2_super_inode_write(idir);
+    } else {
+        inod->links = 0;    /* Released by the iput */
+    }
+    iput(&inod->base);
+    return res;
+}
+
+/*
+ * Remove a directory entry. The inode is released by the last iput
+ * following the removal of its last link.
+ */
+static int ext2_remove(struct ext2_inode *dir, const char *name, int isdir)
+{
+    struct ext2_disk_dirent *curr, *prev;
+    struct ext2_inode *inod;
+    struct buf *bp;
+    int res = 0;
+
+    curr = ext2_dir_find(dir, name, &bp, &prev);
+    if (curr == NULL)
+        return -ENOENT;
+    inod = (struct ext2_inode *)iget(dir->base.sb, curr->ino);
+    if (inod == NULL) {
+        brelse(bp);
+        return -EIO;
+    }
+
+    if (isdir != 0 && !S_ISDIR(inod->base.mode))
+        res = -ENOTDIR;
+    else if (isdir == 0 && S_ISDIR(inod->base.mode))
+        res = -EISDIR;
+    else if (isdir != 0 && ext2_dir_empty(inod) == 0)
+        res = -ENOTEMPTY;
+
+    if (res == 0) {
+        ext2_dir_del(bp, curr, prev);
+        if (isdir != 0) {
+            /* The ".." entry was a link to the parent */
+            inod->links = 0;
+            dir->links--;
+            ext2_super_inode_write(&dir->base);
+        } else {
+            inod->links--;
         }
-        if((curr->rec_len) == 0)
-            break;
-        count -= curr->rec_len;
-        curr = (struct ext2_disk_dirent *)((char *)curr + curr->rec_len);
+        ext2_super_inode_write(&inod->base);
     }
-end:
-    kfree(dirbuf, dir->size);
-    return inod;
+    brelse(bp);
+    iput(&inod->base);
+    return res;
+}
+
+static int ext2_unlink(struct inode *idir, const char *name)
+{
+    return ext2_remove((struct ext2_inode *)idir, name, 0);
+}
+
+static int ext2_rmdir(struct inode *idir, const char *name)
+{
+    return ext2_remove((struct ext2_inode *)idir, name, 1);
+}
+
+/*
+ * Move a directory entry, replacing the target if it exists.
+ * The target is removed before the new entry is added, thus the
+ * replacement is not atomic.
+ */
+static int ext2_rename(struct inode *iodir, const char *oname,
+                       struct inode *indir, const char *nname)
+{
+    struct ext2_inode *odir = (struct ext2_inode *)iodir;
+    struct ext2_inode *ndir = (struct ext2_inode *)indir;
+    struct ext2_disk_dirent *curr, *prev;
+    struct ext2_inode *inod;
+    struct buf *bp;
+    int isdir, res = 0;
+
+    curr = ext2_dir_find(odir, oname, &bp, NULL);
+    if (curr == NULL)
+        return -ENOENT;
+    inod = (struct ext2_inode *)iget(iodir->sb, curr->ino);
+    brelse(bp);
+    if (inod == NULL)
+        return -EIO;
+    isdir = S_ISDIR(inod->base.mode);
+
+    curr = ext2_dir_find(ndir, nname, &bp, NULL);
+    if (curr != NULL) {
+        res = (curr->ino == inod->base.ino) ? 1 : 0;
+        brelse(bp);
+        if (res == 0)
+            res = ext2_remove(ndir, nname, isdir);
+    }
+    if (res == 0)
+        res = ext2_dir_add(ndir, nname, inod->base.ino, inod->base.mode);
+    if (res == 0) {
+        curr = ext2_dir_find(odir, oname, &bp, &prev);
+        if (curr != NULL) {
+            ext2_dir_del(bp, curr, prev);
+            brelse(bp);
+        }
+        if (isdir != 0 && odir != ndir) {
+            curr = ext2_dir_find(inod, "..", &bp, NULL);
+            if (curr != NULL) {
+                curr->ino = indir->ino;
+                bdirty(bp);
+                brelse(bp);
+            }
+            odir->links--;
+            ext2_super_inode_write(iodir);
+            ndir->links++;
+            ext2_super_inode_write(indir);
+        }
+    }
+    iput(&inod->base);
+    return (res > 0) ? 0 : res;
 }
 
 
 static const struct inode_ops ext2_inode_ops = {
-    .read   = (inode_read_t)ext2_read,
-    .lookup = ext2_lookup,
+    .read      = (inode_read_t)ext2_read,
+    .write     = (inode_write_t)ext2_write,
+    .mknod     = ext2_mknod,
+    .lookup    = ext2_lookup,
+    .unlink    = ext2_unlink,
+    .mkdir     = ext2_mkdir,
+    .rmdir     = ext2_rmdir,
+    .rename    = ext2_rename,
+    .truncate  = ext2_truncate,
+    .writeback = ext2_writeback,
 };
 
 
@@ -265,54 +1075,65 @@ static const struct inode_ops ext2_inode_ops = {
  *  Dentry operations
  ******************************************************************************/
 
-static int ext2_readdir(struct inode *dir, unsigned int i,
-                        struct dirent *dent)
+/*
+ * Read the directory entries from the byte offset pos. The offset is only
+ * advanced past the consumed entries, thus it always refers to an entry
+ * boundary unless the file position has been changed with a seek; in that
+ * case the entries starting before pos within the block are skipped.
+ */
+static int ext2_readdir(struct inode *dir, size_t *pos,
+                        struct dirent *dents, size_t count)
 {
-    struct ext2_disk_dirent *curr;
-    struct ext2_disk_dirent *dirbuf;
-    size_t count, n;
-    int ret = -1;
-
-    dirbuf = (struct ext2_disk_dirent *)kmalloc(dir->size, 0);
-    if (dirbuf == NULL)
-        return -ENOMEM;
-
-    ret = devfs_read(dir->sb->dev, dirbuf, dir->size,
-                    ((struct ext2_inode *)dir)->blocks[0] * 1024);
-    if (ret != dir->size) {
-        if (ret >= 0)
-            ret = -EIO;
-        goto end;
-    }
-
-    count = dir->size;
-    curr = dirbuf;
-    n = 0;
-    while(count >= sizeof(struct ext2_disk_dirent)) {
-        if (n++ == i) {
-            n = MIN(curr->name_len, NAME_MAX);
-            memcpy(&dent->d_name, curr->name, n);
-            dent->d_name[n] = '\0';
-            dent->d_ino = curr->ino;
-            ret = 0;
+    const struct ext2_super_block *sb;
+    const struct ext2_disk_dirent *curr;
+    struct buf *bp;
+    size_t off, base, blk_off, len;
+    int block, full = 0, res = 0, n = 0;
+
+    sb = (struct ext2_super_block *)dir->sb;
+    off = *pos;
+    while (full == 0 && off < dir->size) {
+        block = ext2_bmap((struct ext2_inode *)dir,
+                          off >> (10 + sb->log_block_size), 0);
+        bp = (block > 0) ? bread(sb->base.dev, block, sb->block_size) : NULL;
+        if (bp == NULL) {
+            res = (block < 0) ? block : -EIO;
             break;
         }
-        if((curr->rec_len) == 0)
-            break;
-        count -= curr->rec_len;
-        curr = (struct ext2_disk_dirent *)((char *)curr + curr->rec_len);
+        base = off & ~(size_t)(sb->block_size - 1);
+        for (blk_off = 0; blk_off + 8 <= sb->block_size;
+             blk_off += curr->rec_len) {
+            curr = (struct ext2_disk_dirent *)(bp->data + blk_off);
+            if (curr->rec_len < 8)
+                break;
+            if (base + blk_off < off)
+                continue;
+            if (curr->ino != 0) {
+                if (n == count) {
+                    full = 1;
+                    break;
+                }
+                len = MIN(curr->name_len, NAME_MAX);
+                memcpy(dents[n].d_name, curr->name, len);
+                dents[n].d_name[len] = '\0';
+                dents[n].d_ino = curr->ino;
+                n++;
+            }
+            off = base + blk_off + curr->rec_len;
+        }
+        brelse(bp);
+        if (full == 0)
+            off = base + sb->block_size;
     }
-
-end:
-    kfree(dirbuf, dir->size);
-    return ret;
+    *pos = off;
+    return (n > 0) ? n : res;
 }
 
 
-static int ext2_dentry_readdir(struct dentry *dir, unsigned int i,
-                               struct dirent *dent)
+static int ext2_dentry_readdir(struct dentry *dir, size_t *pos,
+                               struct dirent *dents, size_t count)
 {
-    return ext2_readdir(dir->inod, i, dent);
+    return ext2_readdir(dir->inod, pos, dents, count);
 }
 
 static const struct dentry_ops ext2_dentry_ops = {
@@ -332,12 +1153,26 @@ static struct inode *ext2_super_inode_alloc(struct super_block *sb)
 
     inod = (struct inode *)kmalloc(sizeof(struct ext2_inode), 0);
     if (inod != NULL)
-        memset(inod, 0, sizeof(*inod));
+        memset(inod, 0, sizeof(struct ext2_inode));
     return inod;
 }
 
+static int ext2_super_inode_drop(struct inode *inod)
+{
+    return ((struct ext2_inode *)inod)->links == 0;
+}
+
 static void ext2_super_inode_free(struct inode *inod)
 {
+    struct ext2_inode *ext2_inod = (struct ext2_inode *)inod;
+
+    if (ext2_inod->links == 0)
+        ext2_inode_release(ext2_inod);
+
+    ext2_prealloc_release(ext2_inod);
+    if (ext2_inod->map != NULL)
+        kfree(ext2_inod->map,
+              ((struct ext2_super_block *)inod->sb)->block_size);
     kfree(inod, sizeof(struct ext2_inode));
 }
 
@@ -346,48 +1181,70 @@ static void ext2_super_inode_free(struct inode *inod)
  */
 static int ext2_super_inode_read(struct inode *inod)
 {
-    int n;
-    struct ext2_disk_inode disk_inod;
-    const struct ext2_super_block *sb = (struct ext2_super_block *) inod->sb;
-    int group = ((inod->ino - 1) / sb->inodes_per_group);
-    const struct ext2_group_desc *gd = &sb->gd_table[group];
-    int table_index = (inod->ino - 1 ) % sb->inodes_per_group;
-    int blockno = ((table_index * 128) / 1024 ) + gd->inode_table;
-    int ind = table_index % (1024 /128);
-
-    n = devfs_read(sb->base.dev, &disk_inod, sizeof(disk_inod),
-                   blockno * 1024 + ind*sizeof(disk_inod));
-    if (n != sizeof(disk_inod))
+    struct ext2_inode *ext2_inod = (struct ext2_inode *)inod;
+    const struct ext2_disk_inode *dinod;
+    struct buf *bp;
+
+    bp = ext2_inode_buf((struct ext2_super_block *)inod->sb, inod->ino,
+                        (struct ext2_disk_inode **)&dinod);
+    if (bp == NULL)
         return -1;
 
     inod->ops = &ext2_inode_ops;
-    inod->mode = disk_inod.mode;
-    inod->uid = disk_inod.uid;
-    inod->gid = disk_inod.gid;
+    inod->mode = dinod->mode;
+    inod->uid = dinod->uid;
+    inod->gid = dinod->gid;
     if (S_ISCHR(inod->mode) || S_ISBLK(inod->mode))
-        inod->rdev  = disk_inod.block[0];
-    inod->size = disk_inod.size;
-    inod->atime = disk_inod.atime;
-    inod->mtime = disk_inod.mtime;
-    inod->ctime = disk_inod.ctime;
-
-#if 0
-    inod->blksize = 512; /* sure ??? */
-    inod->blocks = (disk_inod.size-1)/inod->blksize+1;
-#endif
-
-    memcpy(((struct ext2_inode *)inod)->blocks, disk_inod.block,
-            sizeof(disk_inod.block));
-
+        inod->rdev  = dinod->block[0];
+    inod->size = dinod->size;
+    inod->atime = dinod->atime;
+    inod->mtime = dinod->mtime;
+    inod->ctime = dinod->ctime;
+    ext2_inod->links = dinod->links_count;
+    ext2_inod->sectors = dinod->blocks;
+
+    memcpy(ext2_inod->blocks, dinod->block, sizeof(dinod->block));
+    brelse(bp);
     return 0;
 }
 
+/*
+ * Update the on disk inode in the buffer cache.
+ */
+static int ext2_super_inode_write(struct inode *inod)
+{
+    const struct ext2_inode *ext2_inod = (struct ext2_inode *)inod;
+    struct ext2_disk_inode *dinod;
+    struct buf *bp;
+
+    bp = ext2_inode_buf((struct ext2_super_block *)inod->sb, inod->ino,
+                        &dinod);
+    if (bp == NULL)
+        return -EIO;
+
+    dinod->mode = inod->mode;
+    dinod->uid = inod->uid;
+    dinod->gid = inod->gid;
+    dinod->size = inod->size;
+    dinod->atime = inod->atime;
+    dinod->mtime = inod->mtime;
+    dinod->ctime = inod->ctime;
+    dinod->links_count = ext2_inod->links;
+    dinod->blocks = ext2_inod->sectors;
+    memcpy(dinod->block, ext2_inod->blocks, sizeof(dinod->block));
+
+    bdirty(bp);
+    brelse(bp);
+    return 0;
+}
 
 static const struct super_ops ext2_sb_ops =
 {
     .inode_alloc = ext2_super_inode_alloc,
     .inode_free  = ext2_super_inode_free,
     .inode_read  = ext2_super_inode_read,
+    .inode_write = ext2_super_inode_write,
+    .inode_drop  = ext2_super_inode_drop,
 };
 
 
@@ -400,9 +1257,7 @@ struct super_block *ext2_super_create(dev_t dev)
     struct ext2_super_block *sb;
     struct inode *iroot;
     struct dentry *droot;
-    unsigned int num_groups;
     struct ext2_disk_super_block dsb;
-    uint32_t gd_block;
 
     if (devfs_read(dev, &dsb, sizeof(dsb), 1024) != sizeof(dsb))
         return NULL;
@@ -418,15 +1273,31 @@ struct super_block *ext2_super_create(dev_t dev)
     sb->base.dev = dev;
     sb->log_block_size = dsb.log_block_size;
     sb->block_size = 1024 << dsb.log_block_size;
-    gd_block = (dsb.log_block_size == 0) ? (uint32_t)3 : (uint32_t)2;
-    num_groups = (dsb.blocks_count - 1) / dsb.blocks_per_group + 1;
+    sb->blocks_per_group = dsb.blocks_per_group;
+    sb->first_data_block = dsb.first_data_block;
+    sb->blocks_count = dsb.blocks_count;
+    sb->free_blocks_count = dsb.free_blocks_count;
+    sb->free_inodes_count = dsb.free_inodes_count;
+    if (dsb.rev_level == EXT2_GOOD_OLD_REV) {
+        sb->first_ino = EXT2_GOOD_OLD_FIRST_INO;
+        sb->inode_size = EXT2_GOOD_OLD_INODE_SIZE;
+        sb->feature_incompat = 0;
+    } else {
+        sb->first_ino = dsb.first_ino;
+        sb->inode_size = dsb.inode_size;
+        sb->feature_incompat = dsb.feature_incompat;
+    }
+    /* The descriptors table follows the superblock */
+    sb->gd_first = dsb.first_data_block + 1;
+    sb->groups_count = (dsb.blocks_count - dsb.first_data_block - 1) /
+                       dsb.blocks_per_group + 1;
 
-    n = sizeof(struct ext2_group_desc) * num_groups;
+    n = sizeof(struct ext2_group_desc) * sb->groups_count;
     sb->gd_table = (struct ext2_group_desc *)kmalloc(n, 0);
     if (sb->gd_table == NULL)
         return NULL;
 
-    if (devfs_read(dev, sb->gd_table, n, sb->block_size*(gd_block-1)) != n)
+    if (devfs_read(dev, sb->gd_table, n, sb->block_size * sb->gd_first) != n)
         return NULL;
 
     droot = dentry_create("/", NULL, &ext2_dentry_ops);
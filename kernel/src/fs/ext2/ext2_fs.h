@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Ext2 on disk structures and in memory descriptors, shared by the
+ * filesystem implementation files.
+ */
+
+#ifndef BEEOS_FS_EXT2_EXT2_FS_H_
+#define BEEOS_FS_EXT2_EXT2_FS_H_
+
+#include "fs/vfs.h"
+#include <stdint.h>
+
+#define EXT2_MAGIC          0xef53
+#define EXT2_NDIR_BLOCKS    12  /* Number of direct blocks */
+#define EXT2_BLK_IND        12  /* Indirect blocks index */
+#define EXT2_BLK_DBL        13  /* Double indirect blocks index */
+#define EXT2_BLK_TPL        14  /* Triple indirect blocks index */
+
+#define EXT2_GOOD_OLD_REV           0   /* Revision 0 */
+#define EXT2_GOOD_OLD_INODE_SIZE    128 /* Revision 0 inode size */
+#define EXT2_GOOD_OLD_FIRST_INO     11  /* Revision 0 first usable inode */
+
+#define EXT2_FEATURE_INCOMPAT_FILETYPE  0x0002  /* Dirents file type */
+
+/* Directory entry file types */
+#define EXT2_FT_UNKNOWN     0
+#define EXT2_FT_REG_FILE    1
+#define EXT2_FT_DIR         2
+#define EXT2_FT_CHRDEV      3
+#define EXT2_FT_BLKDEV      4
+#define EXT2_FT_FIFO        5
+#define EXT2_FT_SOCK        6
+#define EXT2_FT_SYMLINK     7
+
+/* Directory entry length for a name length, 4 bytes aligned */
+#define EXT2_DIR_REC_LEN(name_len)  (((name_len) + 8 + 3) & ~3)
+
+/*
+ * Unused macros reserved for future extensions or completeness.
+ */
+
+#define EXT2_BAD_INO            1
+#define EXT2_ROOT_INO           2
+#define EXT2_ACL_IDX_INO        3
+#define EXT2_ACL_DATA_INO       4
+#define EXT2_BOOT_LOADER_INO    5
+#define EXT2_UNDEL_DIR_INO      6
+
+
+struct ext2_disk_super_block {
+    uint32_t inodes_count;      /* Count of inodes in fs */
+    uint32_t blocks_count;      /* Count of blocks in fs */
+    uint32_t r_blocks_count;    /* Count of # of reserved blocks */
+    uint32_t free_blocks_count; /* Count of # of free blocksw */
+    uint32_t free_inodes_count; /* Count of # of free inodes */
+    uint32_t first_data_block;  /* First block that contains data */
+    uint32_t log_block_size;    /* Indicator of block size */
+    int32_t  log_frag_size;     /* Indicator of the size of fragments */
+    uint32_t blocks_per_group;  /* Count of # of blocks in each block group */
+    uint32_t frags_per_group;   /* Count of # of fragments in each block group */
+    uint32_t inodes_per_group;  /* Count of # of inodes in each blcok group */
+    uint32_t mtime;             /* time filesystem was last mounted */
+    uint32_t wtime;             /* time filesystem was last written to */
+    uint16_t mnt_count;         /* number of times the fs has been mounted */
+    int16_t  max_mnt_count;     /* number of times the fs can be mounted */
+    uint16_t magic;             /* EXT2 Magic number */
+    uint16_t state;             /* flags indicating current state of fs */
+    uint16_t errors;            /* flags indicating errors */
+    uint16_t pad;               /* padding */
+    uint32_t lastcheck;         /* time the fs was last checked */
+    uint32_t checkinterval;     /* maximum time between checks */
+    uint32_t creator_os;        /* indicator of which OS created */
+    uint32_t rev_level;         /* EXT2 revision level */
+    uint16_t def_resuid;        /* Default uid for reserved blocks */
+    uint16_t def_resgid;        /* Default gid for reserved blocks */
+    uint32_t first_ino;         /* First non-reserved inode (rev 1) */
+    uint16_t inode_size;        /* Size of inode structure (rev 1) */
+    uint16_t block_group_nr;    /* Block group of this superblock copy */
+    uint32_t feature_compat;    /* Compatible features */
+    uint32_t feature_incompat;  /* Incompatible features */
+    uint32_t feature_ro_compat; /* Read-only compatible features */
+    uint32_t reserved[230];     /* padding to 1024 bytes */
+};
+
+struct ext2_group_desc {
+    uint32_t block_bitmap;  /* address of block containing the block bitmap for this group */
+    uint32_t inode_bitmap;  /* address of block containing the inode bitmap for this group */
+    uint32_t inode_table;   /* address of the block containing the inode table for this group */
+    uint16_t free_blocks_count; /* count of free blocks in group */
+    uint16_t free_inodes_count; /* count of free inodes in group */
+    uint16_t used_dirs_count;   /* number of inodes in this group that are directories */
+    uint16_t pad;
+    uint32_t reserved[3];
+};
+
+struct ext2_disk_inode {
+    uint16_t mode;          /* File mode */
+    uint16_t uid;           /* Owner UID */
+    uint32_t size;          /* size in bytes */
+    uint32_t atime;         /* access time */
+    uint32_t ctime;         /* creation time */
+    uint32_t mtime;         /* modification time */
+    uint32_t dtime;         /* deletion time */
+    uint16_t gid;           /* Group ID */
+    uint16_t links_count;   /* links count */
+    uint32_t blocks;        /* blocks count */
+    uint32_t flags;         /* file flags */
+    uint32_t reserved1;
+    uint32_t block[15];     /* pointers to blocks */
+    uint32_t version;
+    uint32_t file_acl;      /* file ACL */
+    uint32_t dir_acl;       /* directory acl */
+    uint8_t  faddr;         /* fragment address */
+    uint8_t  fsize;         /* fragment size */
+    uint16_t pad1;
+    uint32_t reserved2[3];
+};
+
+struct ext2_disk_dirent {
+    uint32_t ino;
+    uint16_t rec_len;
+    uint8_t  name_len;
+    uint8_t  file_type;
+    char     name[255];
+};
+
+struct ext2_super_block {
+    struct super_block      base;
+    uint32_t                block_size;
+    uint32_t                inodes_per_group;
+    uint32_t                log_block_size;
+    uint32_t                blocks_per_group;
+    uint32_t                first_data_block;
+    uint32_t                blocks_count;
+    uint32_t                free_blocks_count;
+    uint32_t                free_inodes_count;
+    uint32_t                first_ino;      /* First non-reserved inode */
+    uint32_t                inode_size;     /* On disk inode size */
+    uint32_t                feature_incompat;
+    uint32_t                groups_count;
+    uint32_t                gd_first;       /* First group descriptors block */
+    uint32_t                dalloc;         /* Blocks reserved by dirty pages */
+    struct ext2_group_desc *gd_table;
+};
+
+struct ext2_inode {
+    struct inode base;
+    uint32_t blocks[15]; /* pointers to blocks */
+    uint16_t links;      /* Hard links count */
+    uint32_t sectors;    /* Allocated 512 bytes sectors */
+    uint32_t goal;       /* Next block allocation goal */
+    uint32_t pa_start;   /* Preallocation window first block */
+    uint32_t pa_count;   /* Preallocation window blocks */
+    uint32_t pa_hint;    /* Blocks expected to be allocated soon */
+    uint32_t dalloc;     /* Blocks reserved by the dirty pages */
+    int      wb_error;   /* Write back error, reported by the next sync */
+    uint32_t *map;       /* Copy of the last used leaf indirect block */
+    uint8_t  map_depth;  /* Cached leaf indirection depth (0 if none) */
+    uint32_t map_index;  /* Cached leaf index within its depth */
+};
+
+
+/**
+ * Allocate a run of contiguous blocks as close as possible to a goal
+ * block: first within the goal group, from the goal position, then in
+ * the following groups. The run may be shorter than requested.
+ *
+ * @param sb    Superblock.
+ * @param goal  Goal block.
+ * @param count Wanted blocks.
+ * @param got   Allocated blocks.
+ * @return      First block number or 0 if the filesystem is full.
+ */
+uint32_t ext2_balloc(struct ext2_super_block *sb, uint32_t goal,
+                     unsigned int count, unsigned int *got);
+
+/**
+ * Release a block.
+ *
+ * @param sb    Superblock.
+ * @param block Block number.
+ */
+void ext2_bfree(struct ext2_super_block *sb, uint32_t block);
+
+/**
+ * Allocate an inode. Regular files are placed in the parent directory
+ * group, directories are spread in the group with more free inodes.
+ *
+ * @param sb    Superblock.
+ * @param dir   Parent directory inode number.
+ * @param isdir Set if the inode is for a directory.
+ * @return      Inode number or 0 if no inodes are available.
+ */
+ino_t ext2_ialloc(struct ext2_super_block *sb, ino_t dir, int isdir);
+
+/**
+ * Release an inode.
+ *
+ * @param sb    Superblock.
+ * @param ino   Inode number.
+ * @param isdir Set if the inode was a directory.
+ */
+void ext2_ifree(struct ext2_super_block *sb, ino_t ino, int isdir);
+
+#endif /* BEEOS_FS_EXT2_EXT2_FS_H_ */
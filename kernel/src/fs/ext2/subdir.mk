@@ -1,2 +1,2 @@
 
-local_sources := ext2.c
+local_sources := ext2.c alloc.c
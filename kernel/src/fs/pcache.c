@@ -0,0 +1,351 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "fs/pcache.h"
+#include "fs/vfs.h"
+#include "mm/slab.h"
+#include "kmalloc.h"
+#include "kprintf.h"
+#include "timer.h"
+#include "util.h"
+#include "proc/kthread.h"
+#include "arch/x86/paging_bits.h"
+#include <string.h>
+
+#define PCACHE_MAX          256 /* Maximum number of cached pages */
+#define PCACHE_HTABLE_BITS  7   /* 128 buckets hash table */
+
+#define RA_MIN_PAGES        2   /* Initial read-ahead window */
+#define RA_MAX_PAGES        16  /* Maximum read-ahead window */
+
+#define DIRTY_MAX_PAGES     64  /* Dirty pages triggering a write back */
+#define DIRTY_EXPIRE_MSECS  5000 /* Dirty pages maximum age */
+
+#define KEY(inod, index)    (((uint64_t)(uintptr_t)(inod) << 32) | (index))
+
+static struct slab_cache cpage_cache;
+static struct htable_link *pcache_htable[1 << PCACHE_HTABLE_BITS];
+
+/* Unreferenced clean pages, least recently used first */
+static struct list_link pcache_lru;
+
+/* Dirty pages, oldest first */
+static struct list_link pcache_dirty_list;
+
+/* Dirty pages write back, armed by the first dirty page */
+static struct timer_event pcache_flush_tm;
+static struct work pcache_flush_work;
+static int pcache_flush_armed;
+static int pcache_flushing;
+
+static struct pcache_stats stats;
+
+
+static struct cpage *pcache_lookup(const struct inode *inod, uint32_t index)
+{
+    struct cpage *pg;
+    struct htable_link *lnk;
+
+    lnk = htable_lookup(pcache_htable, KEY(inod, index), PCACHE_HTABLE_BITS);
+    while (lnk != NULL) {
+        pg = struct_ptr(lnk, struct cpage, hlink);
+        if (pg->inod == inod && pg->index == index)
+            return pg;
+        lnk = lnk->next;
+    }
+    return NULL;
+}
+
+struct cpage *pcache_find(const struct inode *inod, uint32_t index)
+{
+    return pcache_lookup(inod, index);
+}
+
+static void pcache_unlink(struct cpage *pg)
+{
+    htable_delete(&pg->hlink);
+    list_delete(&pg->ilink);
+    if ((pg->flags & CPAGE_DIRTY) != 0) {
+        list_delete(&pg->dlink);
+        stats.dirty--;
+    }
+}
+
+/*
+ * Get an unused page, allocating a new one while below the cache limit
+ * or recycling the least recently used one.
+ */
+static struct cpage *pcache_alloc(void)
+{
+    struct cpage *pg;
+
+    if (stats.pages < PCACHE_MAX) {
+        pg = (struct cpage *)slab_cache_alloc(&cpage_cache, 0);
+        if (pg != NULL) {
+            pg->data = (char *)kmalloc(PAGE_SIZE, 0);
+            if (pg->data != NULL) {
+                stats.pages++;
+                return pg;
+            }
+            slab_cache_free(&cpage_cache, pg);
+        }
+    }
+
+    if (list_empty(&pcache_lru))
+        return NULL;
+    pg = list_container(pcache_lru.next, struct cpage, lru);
+    list_delete(&pg->lru);
+    pcache_unlink(pg);
+    stats.evicts++;
+    return pg;
+}
+
+static void pcache_release(struct cpage *pg)
+{
+    kfree(pg->data, PAGE_SIZE);
+    slab_cache_free(&cpage_cache, pg);
+    stats.pages--;
+}
+
+static struct cpage *pcache_fill(struct inode *inod, uint32_t index,
+                                 pcache_fill_t fill)
+{
+    struct cpage *pg;
+
+    pg = pcache_alloc();
+    if (pg == NULL)
+        return NULL;
+    if (fill(inod, pg->data, index) < 0) {
+        pcache_release(pg);
+        return NULL;
+    }
+    pg->inod = inod;
+    pg->index = index;
+    pg->ref = 1;
+    pg->flags = 0;
+    htable_insert(pcache_htable, &pg->hlink, KEY(inod, index),
+                  PCACHE_HTABLE_BITS);
+    list_insert_before(&inod->pages, &pg->ilink);
+    return pg;
+}
+
+struct cpage *pcache_get(struct inode *inod, uint32_t index,
+                         pcache_fill_t fill)
+{
+    struct cpage *pg;
+
+    pg = pcache_lookup(inod, index);
+    if (pg != NULL) {
+        stats.hits++;
+        if (pg->ref++ == 0 && (pg->flags & CPAGE_DIRTY) == 0)
+            list_delete(&pg->lru);
+        return pg;
+    }
+    stats.misses++;
+    return pcache_fill(inod, index, fill);
+}
+
+void pcache_put(struct cpage *pg)
+{
+    if (--pg->ref == 0 && (pg->flags & CPAGE_DIRTY) == 0)
+        list_insert_before(&pcache_lru, &pg->lru);
+    if (stats.dirty > DIRTY_MAX_PAGES && pcache_flushing == 0)
+        pcache_writeback(NULL, 0);
+}
+
+static void pcache_flush(void *arg)
+{
+    (void)arg;
+    pcache_writeback(NULL, 0);
+}
+
+/* Timer callback, runs in interrupt context */
+static void pcache_flush_timer(void *arg)
+{
+    (void)arg;
+    pcache_flush_armed = 0;
+    work_schedule(&pcache_flush_work);
+}
+
+void pcache_dirty(struct cpage *pg)
+{
+    if ((pg->flags & CPAGE_DIRTY) != 0)
+        return;
+    pg->flags = (pg->flags & ~CPAGE_ERROR) | CPAGE_DIRTY;
+    list_insert_before(&pcache_dirty_list, &pg->dlink);
+    stats.dirty++;
+    if (pcache_flush_armed == 0) {
+        pcache_flush_armed = 1;
+        timer_event_mod(&pcache_flush_tm,
+                        timer_ticks + msecs_to_ticks(DIRTY_EXPIRE_MSECS));
+    }
+}
+
+void pcache_clean(struct cpage *pg)
+{
+    if ((pg->flags & CPAGE_DIRTY) == 0)
+        return;
+    pg->flags &= ~CPAGE_DIRTY;
+    list_delete(&pg->dlink);
+    stats.dirty--;
+    stats.cleaned++;
+    if (pg->ref == 0)
+        list_insert_before(&pcache_lru, &pg->lru);
+}
+
+void pcache_error(struct cpage *pg)
+{
+    if ((pg->flags & CPAGE_DIRTY) == 0)
+        return;
+    pcache_clean(pg);
+    pg->flags |= CPAGE_ERROR;
+    stats.cleaned--;
+    stats.errors++;
+}
+
+int pcache_writeback(struct inode *inod, int sync)
+{
+    struct cpage *pg;
+    int err, res = 0;
+
+    if (inod != NULL)
+        return vfs_writeback(inod, sync);
+
+    /*
+     * The inode write back cleans all its pages, failed ones included,
+     * the list shrinks. Stop if no progress is made.
+     */
+    pcache_flushing = 1;
+    while (!list_empty(&pcache_dirty_list)) {
+        pg = list_container(pcache_dirty_list.next, struct cpage, dlink);
+        err = vfs_writeback(pg->inod, sync);
+        if (err < 0 && res == 0)
+            res = err;
+        if (pg == list_container(pcache_dirty_list.next,
+                                 struct cpage, dlink))
+            break;
+    }
+    pcache_flushing = 0;
+    return res;
+}
+
+/*
+ * Fill the pages following the last read one that are not cached yet.
+ * The window is updated according to the access pattern.
+ */
+static void pcache_readahead(struct inode *inod, size_t off, size_t end,
+                             pcache_fill_t fill)
+{
+    uint32_t index, last;
+    struct cpage *pg;
+
+    if (off == 0 || off != inod->ra_next) {
+        inod->ra_pages = (off == 0) ? RA_MIN_PAGES : 0;
+    } else {
+        inod->ra_pages = (inod->ra_pages == 0) ? RA_MIN_PAGES :
+                         MIN(2 * inod->ra_pages, RA_MAX_PAGES);
+    }
+    inod->ra_next = end;
+    if (inod->ra_pages == 0 || end >= inod->size)
+        return;
+
+    index = (end - 1) / PAGE_SIZE + 1;
+    last = MIN(index + inod->ra_pages, (inod->size - 1) / PAGE_SIZE + 1);
+    for (; index < last; index++) {
+        if (pcache_lookup(inod, index) != NULL)
+            continue;
+        pg = pcache_fill(inod, index, fill);
+        if (pg == NULL)
+            break;
+        stats.ahead++;
+        pcache_put(pg);
+    }
+}
+
+ssize_t pcache_read(struct inode *inod, void *buf, size_t count, size_t off,
+                    pcache_fill_t fill)
+{
+    struct cpage *pg;
+    size_t left, pg_off, n;
+
+    if (inod->size <= off)
+        return 0; /* EOF */
+    if (inod->size < off + count)
+        count = inod->size - off;
+
+    left = count;
+    while (left > 0) {
+        pg = pcache_get(inod, (off + count - left) / PAGE_SIZE, fill);
+        if (pg == NULL)
+            break;
+        pg_off = (off + count - left) % PAGE_SIZE;
+        n = MIN(left, PAGE_SIZE - pg_off);
+        memcpy(buf, pg->data + pg_off, n);
+        pcache_put(pg);
+        left -= n;
+        buf = (char *)buf + n;
+    }
+    if (count != left)
+        pcache_readahead(inod, off, off + count - left, fill);
+    return count - left;
+}
+
+void pcache_invalidate(struct inode *inod)
+{
+    struct cpage *pg;
+
+    /* Inodes not initialized by the VFS have no pages (e.g. pipes) */
+    if (inod->pages.next == NULL)
+        return;
+    while (!list_empty(&inod->pages)) {
+        pg = list_container(inod->pages.next, struct cpage, ilink);
+        if (pg->ref == 0 && (pg->flags & CPAGE_DIRTY) == 0)
+            list_delete(&pg->lru);
+        pcache_unlink(pg);
+        pcache_release(pg);
+    }
+    inod->ra_next = 0;
+    inod->ra_pages = 0;
+}
+
+void pcache_stats_get(struct pcache_stats *st)
+{
+    *st = stats;
+}
+
+void pcache_dump(void)
+{
+    kprintf("pages: %u, hits: %u, misses: %u, ahead: %u, evicts: %u, "
+            "dirty: %u, cleaned: %u\n",
+            (unsigned int)stats.pages, (unsigned int)stats.hits,
+            (unsigned int)stats.misses, (unsigned int)stats.ahead,
+            (unsigned int)stats.evicts, (unsigned int)stats.dirty,
+            (unsigned int)stats.cleaned);
+}
+
+void pcache_init(void)
+{
+    slab_cache_init(&cpage_cache, "cpage-cache", sizeof(struct cpage),
+            0, 0, NULL, NULL);
+    htable_init(pcache_htable, PCACHE_HTABLE_BITS);
+    list_init(&pcache_lru);
+    list_init(&pcache_dirty_list);
+    timer_event_init(&pcache_flush_tm, pcache_flush_timer, NULL, 0);
+    work_init(&pcache_flush_work, pcache_flush, NULL);
+}
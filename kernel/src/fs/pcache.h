@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * File data page cache.
+ *
+ * Regular files content is cached in page sized chunks indexed by inode
+ * and file page index. The filesystem provides a function to fill a page
+ * on miss. Unreferenced pages are kept in a LRU list and recycled when
+ * the cache is full. Sequential reads open a read-ahead window which is
+ * doubled on each sequential access up to a maximum, random accesses
+ * close it.
+ *
+ * Written pages are marked dirty and stay in the cache until the owner
+ * filesystem writes them back (inode writeback operation). This happens
+ * when too many pages are dirty, a few seconds after the first page got
+ * dirty, or on an explicit sync request. Pages that can't be written back
+ * are marked with an error and no longer retried, thus a full or failing
+ * device does not pin the cache.
+ */
+
+#ifndef BEEOS_FS_PCACHE_H_
+#define BEEOS_FS_PCACHE_H_
+
+#include "htable.h"
+#include "list.h"
+#include <sys/types.h>
+#include <stdint.h>
+
+struct inode;
+
+/** Page content is newer than the device one */
+#define CPAGE_DIRTY     0x01
+/** Last write back failed, the content may be lost once recycled */
+#define CPAGE_ERROR     0x02
+
+/** Cached page. */
+struct cpage {
+    struct htable_link  hlink;  /**< Hash table link */
+    struct list_link    lru;    /**< LRU list link (when clean and unused) */
+    struct list_link    ilink;  /**< Inode pages list link */
+    struct list_link    dlink;  /**< Dirty pages list link */
+    struct inode        *inod;  /**< Owner inode */
+    uint32_t            index;  /**< File page index */
+    int                 ref;    /**< References count */
+    unsigned int        flags;  /**< Page flags (CPAGE_*) */
+    char                *data;  /**< Page data */
+};
+
+/** Page cache statistics. */
+struct pcache_stats {
+    unsigned long   pages;      /**< Allocated pages */
+    unsigned long   hits;       /**< Lookups satisfied by the cache */
+    unsigned long   misses;     /**< Lookups requiring a fill */
+    unsigned long   ahead;      /**< Pages filled by read-ahead */
+    unsigned long   evicts;     /**< Recycled pages */
+    unsigned long   dirty;      /**< Dirty pages */
+    unsigned long   cleaned;    /**< Pages written back */
+    unsigned long   errors;     /**< Pages failed to be written back */
+};
+
+/**
+ * Page fill function, provided by the filesystem.
+ * The part of the page beyond the end of file shall be zeroed.
+ *
+ * @param inod  File inode.
+ * @param data  Page data.
+ * @param index File page index.
+ * @return      0 on success, a negative error number on failure.
+ */
+typedef int (*pcache_fill_t)(struct inode *inod, void *data, uint32_t index);
+
+/**
+ * Get a referenced cached page, filling it on miss.
+ *
+ * @param inod  File inode.
+ * @param index File page index.
+ * @param fill  Page fill function.
+ * @return      Page or NULL on failure.
+ */
+struct cpage *pcache_get(struct inode *inod, uint32_t index,
+                         pcache_fill_t fill);
+
+/**
+ * Find a cached page, without taking a reference.
+ *
+ * @param inod  File inode.
+ * @param index File page index.
+ * @return      Page or NULL if not cached.
+ */
+struct cpage *pcache_find(const struct inode *inod, uint32_t index);
+
+/**
+ * Release a page obtained via pcache_get.
+ *
+ * @param pg    Page.
+ */
+void pcache_put(struct cpage *pg);
+
+/**
+ * Mark a page as dirty.
+ * The page is not recycled until the filesystem marks it clean again.
+ *
+ * @param pg    Referenced page.
+ */
+void pcache_dirty(struct cpage *pg);
+
+/**
+ * Mark a page as clean, once written back by the filesystem.
+ *
+ * @param pg    Page.
+ */
+void pcache_clean(struct cpage *pg);
+
+/**
+ * Give up writing back a dirty page after a write back failure.
+ * The page is marked clean with an error, thus it is not retried and it
+ * can be recycled. The content is kept until then.
+ *
+ * @param pg    Page.
+ */
+void pcache_error(struct cpage *pg);
+
+/**
+ * Write back the dirty pages via the owner inode writeback operation.
+ *
+ * @param inod  File inode, NULL for all the inodes with dirty pages.
+ * @param sync  Set for explicit sync requests (see inode_writeback_t).
+ * @return      0 on success, a negative error number on failure.
+ */
+int pcache_writeback(struct inode *inod, int sync);
+
+/**
+ * Read file data through the page cache, performing read-ahead if the
+ * access is sequential.
+ *
+ * @param inod  File inode.
+ * @param buf   Destination buffer.
+ * @param count Bytes to read.
+ * @param off   File offset.
+ * @param fill  Page fill function.
+ * @return      Number of bytes read.
+ */
+ssize_t pcache_read(struct inode *inod, void *buf, size_t count, size_t off,
+                    pcache_fill_t fill);
+
+/**
+ * Drop all the cached pages of an inode, dirty pages included.
+ *
+ * @param inod  File inode.
+ */
+void pcache_invalidate(struct inode *inod);
+
+/**
+ * Get the page cache statistics.
+ *
+ * @param st    Statistics destination.
+ */
+void pcache_stats_get(struct pcache_stats *st);
+
+/**
+ * Page cache dump function.
+ */
+void pcache_dump(void);
+
+/**
+ * Initialize the page cache.
+ */
+void pcache_init(void);
+
+#endif /* BEEOS_FS_PCACHE_H_ */
@@ -1,3 +1,3 @@
 
-local_sources := vfs.c
+local_sources := vfs.c buf.c pcache.c
 dirs := devfs ext2
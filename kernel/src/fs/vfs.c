@@ -18,6 +18,8 @@
  */
 
 #include "fs/vfs.h"
+#include "fs/buf.h"
+#include "fs/pcache.h"
 #include "fs/devfs/devfs.h"   /* devfs_super_create */
 #include "fs/ext2/ext2.h"    /* ext2_super_create */
 #include "mm/slab.h"
@@ -66,10 +68,21 @@ struct super_block *vfs_super_create(dev_t dev, const char *name)
 static struct slab_cache inode_cache;
 static struct slab_cache file_cache;
 
-#define INODE_HTABLE_BITS     3   /* 8 elements hash table (TODO change) */
-static struct htable_link *inode_htable[1 << INODE_HTABLE_BITS];
+/* Initial and maximum inode hash table size */
+#define INODE_HTABLE_BITS_MIN   6   /* 64 buckets */
+#define INODE_HTABLE_BITS_MAX   12  /* 4096 buckets */
 
-#define KEY(dev, ino)    (((dev) << 16) + (ino))
+static struct htable_link **inode_htable;
+static unsigned int inode_htable_bits;
+static unsigned int inode_hashed;
+
+/* Unused inodes, least recently used first */
+static struct list_link inode_lru;
+static unsigned int inode_unused;
+
+#define INODE_UNUSED_MAX        128
+
+#define IKEY(dev, ino)      (((uint64_t)(dev) << 32) | (ino))
 
 
 struct file *fs_file_alloc(void)
@@ -82,15 +95,70 @@ void fs_file_free(struct file *fil)
     slab_cache_free(&file_cache, fil);
 }
 
+static struct htable_link **inode_htable_alloc(unsigned int bits)
+{
+    struct htable_link **htable;
+
+    htable = (struct htable_link **)kmalloc(sizeof(*htable) << bits, 0);
+    if (htable != NULL)
+        htable_init(htable, bits);
+    return htable;
+}
+
+/*
+ * Double the hash table size, the table is left as is if the allocation
+ * fails.
+ */
+static void inode_htable_grow(void)
+{
+    struct htable_link **htable;
+    struct htable_link *lnk;
+    struct inode *inod;
+    unsigned int i, bits = inode_htable_bits + 1;
+
+    htable = inode_htable_alloc(bits);
+    if (htable == NULL)
+        return;
+    for (i = 0; i < (1U << inode_htable_bits); i++) {
+        while ((lnk = inode_htable[i]) != NULL) {
+            htable_delete(lnk);
+            inod = struct_ptr(lnk, struct inode, hlink);
+            htable_insert(htable, lnk, IKEY(inod->sb->dev, inod->ino), bits);
+        }
+    }
+    kfree(inode_htable, sizeof(*inode_htable) << inode_htable_bits);
+    inode_htable = htable;
+    inode_htable_bits = bits;
+}
+
+static void inode_hash(struct inode *inod)
+{
+    if (inode_hashed >= (2U << inode_htable_bits) &&
+        inode_htable_bits < INODE_HTABLE_BITS_MAX)
+        inode_htable_grow();
+    htable_insert(inode_htable, &inod->hlink,
+                  IKEY(inod->sb->dev, inod->ino), inode_htable_bits);
+    inode_hashed++;
+}
+
+void inode_unhash(struct inode *inod)
+{
+    if (inod->hlink.pprev != NULL) {
+        htable_delete(&inod->hlink);
+        inod->hlink.pprev = NULL;
+        inode_hashed--;
+    }
+}
+
 static struct inode *inode_lookup(dev_t dev, ino_t ino)
 {
     struct inode *ip;
     struct htable_link *lnk;
 
-    lnk = htable_lookup(inode_htable, KEY(dev,ino), INODE_HTABLE_BITS);
+    lnk = htable_lookup(inode_htable, IKEY(dev, ino), inode_htable_bits);
     while (lnk != NULL) {
         ip = struct_ptr(lnk, struct inode, hlink);
-        if (ip->ref > 0 && ip->sb->dev == dev && ip->ino == ino)
+        if (ip->sb->dev == dev && ip->ino == ino)
             return ip;
         lnk = lnk->next;
     }
@@ -107,6 +175,8 @@ static void inode_init(struct inode *inod, struct super_block *sb,
     inod->ino = ino;
     inod->mode = mode;
     inod->sb  = sb;
+    list_init(&inod->pages);
+    list_init(&inod->lru);
 
     /*
      * TODO: consider the inode read return value.
@@ -115,8 +185,24 @@ static void inode_init(struct inode *inod, struct super_block *sb,
     if (sb->ops->inode_read != NULL)
         sb->ops->inode_read(inod);
 
-    htable_insert(inode_htable, &inod->hlink,
-                  KEY(inod->sb->dev, inod->ino), INODE_HTABLE_BITS);
+    inode_hash(inod);
+}
+
+/*
+ * Reclaim the least recently used inodes until the unused ones are at
+ * most max.
+ */
+static void inode_shrink(unsigned int max)
+{
+    struct inode *inod;
+
+    while (inode_unused > max) {
+        inod = list_container(inode_lru.next, struct inode, lru);
+        list_delete(&inod->lru);
+        list_init(&inod->lru);
+        inode_unused--;
+        inode_delete(inod);
+    }
 }
 
 
@@ -126,6 +212,11 @@ struct inode *inode_create(struct super_block *sb, ino_t ino, mode_t mode,
     struct inode *inod;
 
     inod = sb->ops->inode_alloc(sb);
+    /* Under memory pressure give back half of the unused inodes */
+    while (inod == NULL && inode_unused > 0) {
+        inode_shrink(inode_unused / 2);
+        inod = sb->ops->inode_alloc(sb);
+    }
     if (inod != NULL)
         inode_init(inod, sb, ino, mode, ops);
     return inod;
@@ -133,9 +224,11 @@ struct inode *inode_create(struct super_block *sb, ino_t ino, mode_t mode,
 
 void inode_delete(struct inode *inod)
 {
+    vfs_writeback(inod, 1);
+    pcache_invalidate(inod);
+
     /* Check if was in the hash table (e.g. pipe inodes are not) */
-    if (inod->hlink.pprev != NULL)
-        htable_delete(&inod->hlink);
+    inode_unhash(inod);
 
     if (inod->sb->ops->inode_free != NULL)
         inod->sb->ops->inode_free(inod);
@@ -144,7 +237,6 @@ void inode_delete(struct inode *inod)
 }
 
 
-
 void iput(struct inode *inod)
 {
     inod->ref--;
@@ -153,8 +245,20 @@ void iput(struct inode *inod)
     if (inod->ref < 0)
         kprintf("WARNING iref < 0\n");
 #endif
-    if (inod->ref == 0)
-        inode_delete(inod);
+    if (inod->ref == 0) {
+        /* Unlinked inodes are released by the file system when freed */
+        if (inod->hlink.pprev != NULL &&
+            (inod->sb->ops->inode_drop == NULL ||
+             inod->sb->ops->inode_drop(inod) == 0)) {
+            /* Only clean inodes are kept, the reclaim has no I/O to do */
+            vfs_writeback(inod, 1);
+            list_insert_before(&inode_lru, &inod->lru);
+            inode_unused++;
+            inode_shrink(INODE_UNUSED_MAX);
+        } else {
+            inode_delete(inod);
+        }
+    }
 }
 
 struct inode *iget(struct super_block *sb, ino_t ino)
@@ -166,6 +270,10 @@ struct inode *iget(struct super_block *sb, ino_t ino)
         inod = inode_create(sb, ino, 0, sb->root->inod->ops);
         if (inod == NULL)
             return NULL;
+    } else if (!list_empty(&inod->lru)) {
+        list_delete(&inod->lru);
+        list_init(&inod->lru);
+        inode_unused--;
     }
     inod->ref++;
 #ifdef DEBUG_VFS
@@ -203,7 +311,8 @@ static const char *skipelem(const char *path, char *name)
         path++;
     len = path - s;
     if(len >= NAME_MAX) {
-        memmove(name, s, NAME_MAX);
+        memmove(name, s, NAME_MAX - 1);
+        name[NAME_MAX - 1] = 0;
     } else {
         memmove(name, s, len);
         name[len] = 0;
@@ -215,6 +324,46 @@ static const char *skipelem(const char *path, char *name)
 
 
 
+#define DENTRY_HTABLE_BITS    8   /* 256 buckets */
+static struct htable_link *dentry_htable[1 << DENTRY_HTABLE_BITS];
+
+/* Unused dentries, least recently used first */
+static struct list_link dentry_lru;
+static unsigned int dentry_unused;
+
+#define DENTRY_UNUSED_MAX     256
+
+#define DKEY(parent, hash) \
+    (((uint64_t)(uintptr_t)(parent) << 32) | (hash))
+
+
+/* FNV-1a string hash */
+static uint32_t name_hash(const char *name)
+{
+    uint32_t h = 2166136261U;
+
+    while (*name != '\0') {
+        h ^= (unsigned char)*name++;
+        h *= 16777619U;
+    }
+    return h;
+}
+
+static void dentry_hash(struct dentry *dent)
+{
+    dent->hash = name_hash(dent->name);
+    htable_insert(dentry_htable, &dent->hlink,
+                  DKEY(dent->parent, dent->hash), DENTRY_HTABLE_BITS);
+}
+
+static void dentry_unhash(struct dentry *dent)
+{
+    if (dent->hlink.pprev != NULL) {
+        htable_delete(&dent->hlink);
+        dent->hlink.pprev = NULL;
+    }
+}
+
 struct dentry *dentry_create(const char *name, struct dentry *parent,
                              const struct dentry_ops *ops)
 {
@@ -226,49 +375,126 @@ struct dentry *dentry_create(const char *name, struct dentry *parent,
     strcpy(de->name, name);
     de->ref = 0;
     de->inod = NULL; /* May be without an inode */
-    de->parent = (parent != NULL) ? parent : de;
-    list_init(&de->child);  /* Empty children list */
-    list_insert_before(&de->parent->child, &de->link); /* Insert in the parent child  list */
+    de->hlink.pprev = NULL;
+    list_init(&de->lru);
     de->mounted = 0;
     de->ops = ops;
+    if (parent != NULL) {
+        de->parent = ddup(parent);
+        dentry_hash(de);
+    } else {
+        de->parent = de;
+    }
     return de;
 }
 
 void dentry_delete(struct dentry *dent)
 {
-    struct list_link *curr;
-    struct dentry *curr_de;
+    dentry_unhash(dent);
+    kfree(dent, sizeof(struct dentry));
+}
 
-    /* Eventually remove the reference in the children */
-    curr = dent->child.next;
-    while (curr != &dent->child) {
-        curr_de = list_container(curr, struct dentry, link);
-        curr_de->parent = NULL;
-        curr = curr->next;
+/*
+ * Release an unused dentry together with its inode reference.
+ * The reference to the parent is dropped as well, thus an unused parent
+ * is either moved to the LRU list or released if no longer in the cache.
+ * Anonymous inodes (e.g. eventfd) have no super block and are not cached,
+ * the owner release operation frees them with the last reference.
+ */
+static void dentry_release(struct dentry *dent)
+{
+    struct dentry *parent;
+    struct inode *inod;
+
+    while (dent != NULL) {
+        parent = (dent->parent != dent) ? dent->parent : NULL;
+        inod = dent->inod;
+        if (inod != NULL && inod->sb != NULL)
+            iput(inod);
+        else if (inod != NULL && --inod->ref == 0)
+            vfs_release(inod);
+        dentry_delete(dent);
+
+        dent = parent;
+        if (dent != NULL) {
+            dent->ref--;
+            if (dent->ref != 0) {
+                dent = NULL;
+            } else if (dent->hlink.pprev != NULL) {
+                list_insert_before(&dentry_lru, &dent->lru);
+                dentry_unused++;
+                dent = NULL;
+            }
+        }
     }
+}
+
+/*
+ * Reclaim the least recently used dentries until the unused ones are
+ * at most max.
+ */
+static void dentry_shrink(unsigned int max)
+{
+    struct dentry *dent;
 
-    /* Delete from siblings list */
-    list_delete(&dent->link);
+    while (dentry_unused > max) {
+        dent = list_container(dentry_lru.next, struct dentry, lru);
+        list_delete(&dent->lru);
+        list_init(&dent->lru);
+        dentry_unused--;
+        dentry_release(dent);
+    }
+}
 
-    kfree(dent, sizeof(struct dentry));
+void dentry_drop(struct dentry *dent)
+{
+    dentry_unhash(dent);
+}
+
+void dentry_move(struct dentry *dent, struct dentry *parent,
+                 const char *name)
+{
+    struct dentry *old = dent->parent;
+
+    dentry_forget(parent, name);
+    dentry_unhash(dent);
+    strcpy(dent->name, name);
+    dent->parent = ddup(parent);
+    dentry_hash(dent);
+    dput(old);
 }
 
 static struct dentry *dentry_lookup(const struct dentry *dir, const char *name)
 {
-    struct list_link *curr;
-    struct dentry *curr_dent;
-    struct dentry *res = NULL;
+    struct htable_link *lnk;
+    struct dentry *curr;
+    uint32_t h = name_hash(name);
 
-    curr = dir->child.next;
-    while (curr != &dir->child) {
-        curr_dent = list_container(curr, struct dentry, link);
-        if (strcmp(curr_dent->name, name) == 0) {
-            res = curr_dent;
-            break;
+    lnk = htable_lookup(dentry_htable, DKEY(dir, h), DENTRY_HTABLE_BITS);
+    while (lnk != NULL) {
+        curr = struct_ptr(lnk, struct dentry, hlink);
+        if (curr->parent == dir && curr->hash == h &&
+            strcmp(curr->name, name) == 0)
+            return curr;
+        lnk = lnk->next;
+    }
+    return NULL;
+}
+
+void dentry_forget(struct dentry *dir, const char *name)
+{
+    struct dentry *dent;
+
+    dent = dentry_lookup(dir, name);
+    if (dent != NULL) {
+        dentry_unhash(dent);
+        if (dent->ref == 0) {
+            list_delete(&dent->lru);
+            list_init(&dent->lru);
+            dentry_unused--;
+            dentry_release(dent);
         }
-        curr = curr->next;
     }
-    return res;
 }
 
 
@@ -280,12 +506,27 @@ struct dentry *dget(struct dentry *dir, const char *name)
     dent = dentry_lookup(dir, name);
     if (dent == NULL) {
         inod = vfs_lookup(dir->inod, name);
-        if (inod == NULL)
-            return NULL;
         dent = dentry_create(name, dir, dir->ops);
-        if (dent == NULL)
+        if (dent == NULL) {
+            /* Unreferenced: back to the unused list or released */
+            if (inod != NULL)
+                iput(idup(inod));
+            return NULL;
+        }
+        if (inod == NULL) {
+            /* Remember the miss, the dentry is unused from the start */
+            list_insert_before(&dentry_lru, &dent->lru);
+            dentry_unused++;
+            dentry_shrink(DENTRY_UNUSED_MAX);
             return NULL;
+        }
         dent->inod = idup(inod);
+    } else if (dent->inod == NULL) {
+        return NULL;    /* Negative dentry */
+    } else if (dent->ref == 0) {
+        list_delete(&dent->lru);
+        list_init(&dent->lru);
+        dentry_unused--;
     }
 
     dent->ref++;
@@ -296,32 +537,6 @@ struct dentry *dget(struct dentry *dir, const char *name)
     return dent;
 }
 
-#if 0
-/*
- * Actually this doesn't work...
- * For example doesn't handle the following case:
- * 1. I'm in the root dir
- * 2. I jump two levels. (e.g. cd /usr/bin)
- * The cwd is still '/' thus the 'usr' dentry reference is destroyed.
- * The getcwd thus is not able to reconstruct the path from the 'dentry parent'
- * hierarchy.
- */
-static int dentry_can_delete(const struct dentry *dent)
-{
-    int res = 1;
-    struct dentry *curr = current->cwd;
-
-    while (curr->parent != curr) {
-        if (curr == dent) {
-            res = 0;
-            break;
-        }
-        curr = curr->parent;
-    }
-    return res;
-}
-#endif
-
 void dput(struct dentry *dent)
 {
     dent->ref--;
@@ -329,17 +544,20 @@ void dput(struct dentry *dent)
 #ifdef DEBUG_VFS
     kprintf("dput: (%s) ino=%d, iref=%d, dref=%d\n",
             dent->name, dent->inod->ino, dent->inod->ref, dent->ref);
-    if (dent->ref < 0)
+    if ((int)dent->ref < 0)
         kprintf("WARNING dref < 0\n");
 #endif
 
-#if 0
-    if (dent->ref == 0 && dentry_can_delete(dent) != 0) {
-        if (dent->inod != NULL)
-            iput(dent->inod);
-        dentry_delete(dent);
+    if (dent->ref == 0) {
+        if (dent->hlink.pprev != NULL) {
+            /* Still in the cache, keep it for the next lookups */
+            list_insert_before(&dentry_lru, &dent->lru);
+            dentry_unused++;
+            dentry_shrink(DENTRY_UNUSED_MAX);
+        } else {
+            dentry_release(dent);
+        }
     }
-#endif
 }
 
 
@@ -361,24 +579,38 @@ int do_mount(struct dentry *mntpt, struct dentry *root)
 }
 
 
-static struct dentry *follow_up(struct dentry *root)
+/*
+ * Return the mount having the dentry as root, NULL if not a mount root.
+ */
+static const struct vfsmount *mount_by_root(const struct dentry *root)
 {
-    struct dentry *res = root;
     const struct list_link *curr;
     const struct vfsmount *mnt;
 
-    /* TODO: this is not efficient... use a hash map here */
     curr = mounts.next;
     while (curr != &mounts) {
         mnt = list_container(curr, struct vfsmount, link);
-        if (mnt->root == res) {
-            dput(mnt->mntpt);
-            res = ddup(mnt->mntpt);
-            /* Reiterate to see if this is a also mount point */
-            curr = mounts.next;
-        } else {
-            curr = curr->next;
-        }
+        if (mnt->root == root)
+            return mnt;
+        curr = curr->next;
+    }
+    return NULL;
+}
+
+/*
+ * Cross mount points upwards, the reference held on the passed dentry
+ * is transferred to the returned one.
+ */
+static struct dentry *follow_up(struct dentry *root)
+{
+    struct dentry *res = root;
+    const struct vfsmount *mnt;
+
+    /* Reiterate while the mount point is also a mount root */
+    while ((mnt = mount_by_root(res)) != NULL) {
+        root = res;
+        res = ddup(mnt->mntpt);
+        dput(root);
     }
     return res;
 }
@@ -394,8 +626,8 @@ static struct dentry *follow_down(struct dentry *mntpt)
     while (curr != &mounts) {
         mnt = list_container(curr, struct vfsmount, link);
         if (mnt->mntpt == res) {
-            dput(res);
             res = ddup(mnt->root);
+            dput(mnt->mntpt);
             /* Reiterate to see if this is a also mount point */
             curr = mounts.next;
         } else {
@@ -407,9 +639,13 @@ static struct dentry *follow_down(struct dentry *mntpt)
 
 
 
-struct dentry *named(const char *path)
+/*
+ * Look up and return the dentry for a path name.
+ * If parent is not zero, return the dentry of the parent directory and
+ * copy the final path element into name.
+ */
+static struct dentry *namex(const char *path, int parent, char *name)
 {
-    char name[NAME_MAX];
     struct dentry *dent;
     struct dentry *tmp;
 
@@ -419,8 +655,16 @@ struct dentry *named(const char *path)
     dent = ddup((*path == '/') ? current->root : current->cwd);
 
     while ((path = skipelem(path, name)) != NULL) {
-        if (!S_ISDIR(dent->inod->mode))
+        if (!S_ISDIR(dent->inod->mode)) {
+            dput(dent);
             return NULL;
+        }
+        if (parent != 0 && *path == '\0') {
+            /* Stop one level early */
+            if (dent->mounted != 0)
+                dent = follow_down(dent);
+            return dent;
+        }
 
         if (strcmp(name, ".") == 0) {
             continue;
@@ -438,23 +682,42 @@ struct dentry *named(const char *path)
             return NULL;
         dent = tmp;
     }
+    if (parent != 0) {
+        dput(dent);
+        return NULL;
+    }
     if (S_ISDIR(dent->inod->mode) && dent->mounted != 0)
         dent = follow_down(dent);
     return dent;
 }
 
+struct dentry *named(const char *path)
+{
+    char name[NAME_MAX];
+
+    return namex(path, 0, name);
+}
+
+struct dentry *named_parent(const char *path, char *name)
+{
+    return namex(path, 1, name);
+}
 
 int dentry_path(struct dentry *dent, char *buf, size_t size)
 {
     int res = 0;
     size_t j;
     size_t slen;
+    const struct vfsmount *mnt;
     struct dentry *curr = dent;
 
     j = size;
     do {
-        if (strcmp(curr->name, "/") == 0)
-            curr = follow_up(curr);
+        if (strcmp(curr->name, "/") == 0) {
+            /* The path is built without holding references */
+            while ((mnt = mount_by_root(curr)) != NULL)
+                curr = mnt->mntpt;
+        }
         if (curr == curr->parent)
             break;
 
@@ -489,7 +752,16 @@ void vfs_init(void)
     slab_cache_init(&file_cache, "file-cache", sizeof(struct file),
             0, 0, NULL, NULL);
 
-    htable_init(inode_htable, INODE_HTABLE_BITS);
+    inode_htable_bits = INODE_HTABLE_BITS_MIN;
+    inode_htable = inode_htable_alloc(inode_htable_bits);
+    if (inode_htable == NULL)
+        panic("Unable to allocate the inode hash table");
+    list_init(&inode_lru);
+    htable_init(dentry_htable, DENTRY_HTABLE_BITS);
+    list_init(&dentry_lru);
 
     list_init(&mounts);
+
+    buf_init();
+    pcache_init();
 }
@@ -25,6 +25,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <dirent.h>
+#include <errno.h>
 
 /*
  * Superblock declarations
@@ -48,12 +49,15 @@ typedef struct inode * (* super_inode_alloc_t)(struct super_block *sb);
 typedef void (* super_inode_free_t)(struct inode *inode);
 typedef int (* super_inode_read_t)(struct inode *inode);
 typedef int (* super_inode_write_t)(struct inode *inode);
+/* Return non zero if an unused inode has to be freed instead of cached */
+typedef int (* super_inode_drop_t)(struct inode *inode);
 
 struct super_ops {
     super_inode_alloc_t   inode_alloc;
     super_inode_free_t    inode_free;
     super_inode_read_t    inode_read;
     super_inode_write_t   inode_write;
+    super_inode_drop_t    inode_drop;
 };
 
 
@@ -92,8 +96,12 @@ struct inode {
     time_t      mtime;  /**< Modification time */
     time_t      ctime;  /**< Creation time */
     struct htable_link      hlink; /**< Link within the hash table */
+    struct list_link        lru;   /**< Unused inodes list link */
     struct super_block      *sb;   /**< Inode superblock */
     const struct inode_ops  *ops;  /**< Inode vfs Operations */
+    struct list_link        pages;    /**< Cached data pages */
+    size_t                  ra_next;  /**< Next sequential read offset */
+    unsigned int            ra_pages; /**< Read-ahead window in pages */
 };
 
 typedef int (* inode_read_t)(struct inode *inode, void *buf,
@@ -102,15 +110,43 @@ typedef int (* inode_read_t)(struct inode *inode, void *buf,
 typedef int (* inode_write_t)(struct inode *inode, const void *buf,
                               size_t count, size_t off);
 
-typedef int (* inode_mknod_t)(struct inode *idir, mode_t mode, dev_t dev);
+typedef int (* inode_mknod_t)(struct inode *idir, const char *name,
+                              mode_t mode, dev_t dev);
 
 typedef struct inode *(* inode_lookup_t)(struct inode *udir, const char *name);
 
+typedef int (* inode_unlink_t)(struct inode *idir, const char *name);
+
+typedef int (* inode_mkdir_t)(struct inode *idir, const char *name,
+                              mode_t mode);
+
+typedef int (* inode_rmdir_t)(struct inode *idir, const char *name);
+
+typedef int (* inode_rename_t)(struct inode *iodir, const char *oname,
+                               struct inode *indir, const char *nname);
+
+typedef int (* inode_truncate_t)(struct inode *inod, size_t size);
+
+/*
+ * Write back the inode dirty cached pages. The sync flag is set for
+ * explicit sync requests, where the on disk state shall be made exact.
+ */
+typedef int (* inode_writeback_t)(struct inode *inod, int sync);
+
+typedef void (* inode_release_t)(struct inode *inod);
+
 struct inode_ops {
-    inode_read_t    read;
-    inode_write_t   write;
-    inode_mknod_t   mknod;
-    inode_lookup_t  lookup;
+    inode_read_t      read;
+    inode_write_t     write;
+    inode_mknod_t     mknod;
+    inode_lookup_t    lookup;
+    inode_unlink_t    unlink;
+    inode_mkdir_t     mkdir;
+    inode_rmdir_t     rmdir;
+    inode_rename_t    rename;
+    inode_truncate_t  truncate;
+    inode_writeback_t writeback;
+    inode_release_t   release;
 };
 
 
@@ -123,14 +159,21 @@ struct dentry {
     unsigned int      ref;             /**< Reference counter */
     struct inode     *inod;            /**< Inode */
     struct dentry    *parent;          /**< Parent directory */
-    struct list_link  child;           /**< Children list (if is a dir) */
-    struct list_link  link;            /**< Siblings link */
+    uint32_t          hash;            /**< Name hash */
+    struct htable_link hlink;          /**< Link within the dentry cache */
+    struct list_link  lru;             /**< Unused dentries list link */
     unsigned char     mounted;         /**< Set to 1 if is a mount point */
     const struct dentry_ops *ops;      /**< Dentry vfs operations */
 };
 
-typedef int (* dentry_readdir_t)(struct dentry *dir, unsigned int i,
-                                 struct dirent *dent);
+/*
+ * Read up to count entries starting from the directory cursor pos, an
+ * opaque position stored in the file offset (0 is the first entry).
+ * The cursor is advanced past the returned entries.
+ * Returns the number of entries, 0 at the end or a negative error number.
+ */
+typedef int (* dentry_readdir_t)(struct dentry *dir, size_t *pos,
+                                 struct dirent *dents, size_t count);
 
 struct dentry_ops {
     dentry_readdir_t readdir; /**< Read directory */
@@ -179,12 +222,74 @@ static inline struct inode *vfs_lookup(struct inode *idir, const char *name)
     return iret;
 }
 
-static inline int vfs_mknod(struct inode *idir, mode_t mode, dev_t dev)
+static inline int vfs_mknod(struct inode *idir, const char *name,
+                            mode_t mode, dev_t dev)
 {
     int ret = -1;
 
     if (S_ISDIR(idir->mode) && idir->ops->mknod)
-        ret = idir->ops->mknod(idir, mode, dev);
+        ret = idir->ops->mknod(idir, name, mode, dev);
+    return ret;
+}
+
+static inline int vfs_unlink(struct inode *idir, const char *name)
+{
+    int ret = -EPERM;
+
+    if (S_ISDIR(idir->mode) && idir->ops->unlink)
+        ret = idir->ops->unlink(idir, name);
+    return ret;
+}
+
+static inline int vfs_mkdir(struct inode *idir, const char *name, mode_t mode)
+{
+    int ret = -EPERM;
+
+    if (S_ISDIR(idir->mode) && idir->ops->mkdir)
+        ret = idir->ops->mkdir(idir, name, mode);
+    return ret;
+}
+
+static inline int vfs_rmdir(struct inode *idir, const char *name)
+{
+    int ret = -EPERM;
+
+    if (S_ISDIR(idir->mode) && idir->ops->rmdir)
+        ret = idir->ops->rmdir(idir, name);
+    return ret;
+}
+
+static inline int vfs_rename(struct inode *iodir, const char *oname,
+                             struct inode *indir, const char *nname)
+{
+    int ret = -EPERM;
+
+    if (S_ISDIR(iodir->mode) && S_ISDIR(indir->mode) && iodir->ops->rename)
+        ret = iodir->ops->rename(iodir, oname, indir, nname);
+    return ret;
+}
+
+static inline int vfs_writeback(struct inode *inod, int sync)
+{
+    int ret = 0;
+
+    if (inod->ops != NULL && inod->ops->writeback)
+        ret = inod->ops->writeback(inod, sync);
+    return ret;
+}
+
+static inline void vfs_release(struct inode *inod)
+{
+    if (inod->ops != NULL && inod->ops->release)
+        inod->ops->release(inod);
+}
+
+static inline int vfs_truncate(struct inode *inod, size_t size)
+{
+    int ret = -EINVAL;
+
+    if (S_ISREG(inod->mode) && inod->ops->truncate)
+        ret = inod->ops->truncate(inod, size);
     return ret;
 }
 
@@ -210,12 +315,13 @@ static inline ssize_t vfs_write(struct inode *node, const void *buf,
 
 
 
-static inline int vfs_readdir(struct dentry *dir, int i, struct dirent *dent)
+static inline int vfs_readdir(struct dentry *dir, size_t *pos,
+                              struct dirent *dents, size_t count)
 {
-    int ret = -1;
+    int ret = -ENOTDIR;
 
     if (S_ISDIR(dir->inod->mode) && dir->ops->readdir)
-        ret = dir->ops->readdir(dir, i, dent);
+        ret = dir->ops->readdir(dir, pos, dents, count);
     return ret;
 }
 
@@ -225,11 +331,25 @@ struct inode *inode_create(struct super_block *sb, ino_t ino, mode_t mode,
 
 void inode_delete(struct inode *inod);
 
+/**
+ * Remove an inode from the inodes hash table, thus a following iget with
+ * the same number will read a fresh copy (e.g. after the on disk inode
+ * has been released and reused).
+ */
+void inode_unhash(struct inode *inod);
+
 
 struct inode *namei(const char *path);
 
 struct inode *iget(struct super_block *sb, ino_t ino);
 
+/**
+ * Release an inode reference. An unused inode still in the hash table is
+ * written back and kept in the cache, thus a following iget does not read
+ * it again from the device, unless the file system drops it (e.g. once
+ * its last link has been removed). Unused inodes are reclaimed in least recently
+ * used order.
+ */
 void iput(struct inode *inod);
 
 static inline struct inode *idup(struct inode *inod)
@@ -242,16 +362,63 @@ static inline struct inode *idup(struct inode *inod)
 }
 
 
+/**
+ * Create a dentry. A dentry with a parent is inserted in the dentry cache
+ * and keeps a reference to the parent until it is deleted.
+ */
 struct dentry *dentry_create(const char *name, struct dentry *parent,
                              const struct dentry_ops *ops);
 
 void dentry_delete(struct dentry *dent);
 
+/**
+ * Detach a dentry from its parent, thus it is not found by following
+ * lookups. The dentry stays valid for the current users.
+ */
+void dentry_drop(struct dentry *dent);
+
+/**
+ * Forget the cached lookup result of a name, to be called after the
+ * name creation to discard a negative dentry.
+ */
+void dentry_forget(struct dentry *dir, const char *name);
+
+/**
+ * Move a dentry under a new parent with a new name.
+ */
+void dentry_move(struct dentry *dent, struct dentry *parent,
+                 const char *name);
+
 
 struct dentry *named(const char *path);
 
+/**
+ * Lookup the parent directory of the last path element.
+ * The last element name is copied to name (NAME_MAX bytes).
+ * Returns NULL if the path has no elements (e.g. "/").
+ */
+struct dentry *named_parent(const char *path, char *name);
+
+/** Check for the "." and ".." special names */
+static inline int name_is_dots(const char *name)
+{
+    return name[0] == '.' &&
+           (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'));
+}
+
+/**
+ * Lookup a directory entry. Failed lookups are cached as negative dentries
+ * (without an inode), thus the following lookups of the same missing name
+ * do not reach the filesystem.
+ *
+ * @return  Referenced dentry or NULL if the name does not exist.
+ */
 struct dentry *dget(struct dentry *dir, const char *name);
 
+/**
+ * Release a dentry reference. Unused dentries are kept in the cache and
+ * reclaimed in least recently used order.
+ */
 void dput(struct dentry *dent);
 
 static inline struct dentry *ddup(struct dentry *dent)
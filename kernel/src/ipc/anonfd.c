@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "anonfd.h"
+#include "proc.h"
+#include <fcntl.h>
+#include <errno.h>
+
+int anonfd_create(struct inode *inod, int flags)
+{
+    int fd;
+    struct file *fil;
+    struct dentry *dent;
+
+    fd = fd_alloc(current->files, 0);
+    if (fd < 0)
+        return fd;  /* Too many open files */
+
+    fil = fs_file_alloc();
+    if (fil == NULL) {
+        fd_free(current->files, fd);
+        return -ENOMEM;
+    }
+    dent = dentry_create("", NULL, NULL);
+    if (dent == NULL) {
+        fs_file_free(fil);
+        fd_free(current->files, fd);
+        return -ENOMEM;
+    }
+    dent->inod = idup(inod);
+    dent->ref = 1;  /* Held by the file */
+
+    fil->flags = O_RDWR | ((unsigned int)flags & ~O_CLOEXEC);
+    fil->ref = 1;
+    fil->off = 0;
+    fil->mode = 0;
+    fil->dent = dent;
+
+    current->files->fd[fd].fil = fil;
+    current->files->fd[fd].flags = (unsigned int)flags & O_CLOEXEC;
+    return fd;
+}
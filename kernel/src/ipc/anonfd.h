@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Descriptors for kernel objects without a file system name
+ * (e.g. eventfd and signalfd).
+ */
+
+#ifndef BEEOS_IPC_ANONFD_H_
+#define BEEOS_IPC_ANONFD_H_
+
+#include "fs/vfs.h"
+
+/**
+ * Open a descriptor referencing an inode.
+ *
+ * @param inod      Inode, a reference is taken by the new file.
+ * @param flags     Open flags (O_CLOEXEC is a descriptor flag).
+ * @return          The descriptor or a negative error number.
+ */
+int anonfd_create(struct inode *inod, int flags);
+
+#endif /* BEEOS_IPC_ANONFD_H_ */
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "ipc/eventfd.h"
+#include "ipc/anonfd.h"
+#include "sync/cond.h"
+#include "fs/vfs.h"
+#include "proc.h"
+#include "kmalloc.h"
+#include <sys/eventfd.h>
+#include <string.h>
+#include <errno.h>
+
+#define EVENTFD_FLAGS   (EFD_SEMAPHORE | EFD_NONBLOCK | EFD_CLOEXEC)
+
+/* Maximum counter value */
+#define EVENTFD_MAX     0xFFFFFFFFFFFFFFFEULL
+
+
+struct eventfd_inode {
+    struct inode base;
+    struct cond  queue;     /**< Blocked readers and writers */
+    uint64_t     count;     /**< Events counter */
+    int          flags;     /**< Creation flags */
+};
+
+
+/*
+ * Return the counter and reset it, or one and decrement it in semaphore
+ * mode. Blocks while the counter is zero.
+ */
+static int eventfd_inode_read(struct inode *inod, void *buf,
+                              size_t count, size_t off)
+{
+    uint64_t val;
+    struct eventfd_inode *enode = (struct eventfd_inode *)inod;
+
+    if (count < sizeof(val))
+        return -EINVAL;
+
+    spinlock_lock(&enode->queue.lock);
+    while (enode->count == 0) {
+        if ((enode->flags & EFD_NONBLOCK) != 0) {
+            spinlock_unlock(&enode->queue.lock);
+            return -EAGAIN;
+        }
+        cond_wait(&enode->queue);
+        /* A sleeping task is woken up by signals as well */
+        if (enode->count == 0 && (current->sigpend & ~current->sigmask)) {
+            spinlock_unlock(&enode->queue.lock);
+            return -EINTR;
+        }
+    }
+    if ((enode->flags & EFD_SEMAPHORE) != 0) {
+        val = 1;
+        enode->count--;
+    } else {
+        val = enode->count;
+        enode->count = 0;
+    }
+    spinlock_unlock(&enode->queue.lock);
+    /* Writers waiting for room */
+    cond_broadcast(&enode->queue);
+
+    memcpy(buf, &val, sizeof(val));
+    return sizeof(val);
+}
+
+/*
+ * Add a value to the counter. Blocks while the counter would overflow.
+ */
+static int eventfd_inode_write(struct inode *inod, const void *buf,
+                               size_t count, size_t off)
+{
+    uint64_t val;
+    struct eventfd_inode *enode = (struct eventfd_inode *)inod;
+
+    if (count < sizeof(val))
+        return -EINVAL;
+    memcpy(&val, buf, sizeof(val));
+    if (val > EVENTFD_MAX)
+        return -EINVAL;
+
+    spinlock_lock(&enode->queue.lock);
+    while (EVENTFD_MAX - enode->count < val) {
+        if ((enode->flags & EFD_NONBLOCK) != 0) {
+            spinlock_unlock(&enode->queue.lock);
+            return -EAGAIN;
+        }
+        cond_wait(&enode->queue);
+        if (EVENTFD_MAX - enode->count < val &&
+            (current->sigpend & ~current->sigmask)) {
+            spinlock_unlock(&enode->queue.lock);
+            return -EINTR;
+        }
+    }
+    enode->count += val;
+    spinlock_unlock(&enode->queue.lock);
+    if (val != 0)
+        cond_broadcast(&enode->queue);
+    return sizeof(val);
+}
+
+static void eventfd_inode_release(struct inode *inod)
+{
+    kfree(inod, sizeof(struct eventfd_inode));
+}
+
+static const struct inode_ops eventfd_ops = {
+    .read = eventfd_inode_read,
+    .write = eventfd_inode_write,
+    .release = eventfd_inode_release
+};
+
+int eventfd_create(unsigned int initval, int flags)
+{
+    int fd;
+    struct eventfd_inode *enode;
+
+    if ((flags & ~EVENTFD_FLAGS) != 0)
+        return -EINVAL;
+
+    enode = (struct eventfd_inode *)kmalloc(sizeof(struct eventfd_inode), 0);
+    if (enode == NULL)
+        return -ENOMEM;
+    memset(enode, 0, sizeof(*enode));
+    enode->base.mode = S_IFIFO | S_IRUSR | S_IWUSR;
+    enode->base.ops = &eventfd_ops;
+    cond_init(&enode->queue);
+    enode->count = initval;
+    enode->flags = flags;
+
+    fd = anonfd_create(&enode->base, flags & (EFD_NONBLOCK | EFD_CLOEXEC));
+    if (fd < 0)
+        kfree(enode, sizeof(struct eventfd_inode));
+    return fd;
+}
@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#ifndef BEEOS_IPC_EVENTFD_H_
+#define BEEOS_IPC_EVENTFD_H_
+
+/**
+ * Create an event notification descriptor.
+ *
+ * @param initval   Counter initial value.
+ * @param flags     EFD_SEMAPHORE, EFD_NONBLOCK and EFD_CLOEXEC.
+ * @return          The descriptor or a negative error number.
+ */
+int eventfd_create(unsigned int initval, int flags);
+
+#endif /* BEEOS_IPC_EVENTFD_H_ */
@@ -208,30 +208,28 @@ int pipe_create(int pipefd[2])
     struct dentry *dent;
     struct file *file0, *file1;
 
-    for (fd0 = 0; fd0 < OPEN_MAX; fd0++) {
-        if (current->fds[fd0].fil == NULL)
-            break;
+    fd0 = fd_alloc(current->files, 0);
+    if (fd0 < 0)
+        return fd0; /* Too many open files */
+    fd1 = fd_alloc(current->files, fd0 + 1);
+    if (fd1 < 0) {
+        fd_free(current->files, fd0);
+        return fd1;
     }
-    for (fd1 = fd0 + 1; fd1 < OPEN_MAX; fd1++) {
-        if (current->fds[fd1].fil == NULL)
-            break;
-    }
-    if (fd1 >= OPEN_MAX)
-        return -EMFILE; /* Too many open files */
 
     inod = pipe_inode_create();
     if (inod == NULL)
-        return -1;
+        goto bad;
 
     /* Inode allocated */
     file0 = fs_file_alloc();
     file1 = fs_file_alloc();
     if (file0 == NULL || file1 == NULL)
-        return -1;
+        goto bad;
 
     dent = dentry_create("", NULL, NULL);
     if (dent == NULL)
-        return -1;
+        goto bad;
     dent->inod = idup(inod);
 
     file0->flags = O_RDONLY;
@@ -242,10 +240,15 @@ int pipe_create(int pipefd[2])
     *file1 = *file0;
     file1->flags = O_WRONLY;
 
-    current->fds[fd0].fil = file0;
-    current->fds[fd1].fil = file1;
+    current->files->fd[fd0].fil = file0;
+    current->files->fd[fd1].fil = file1;
 
     pipefd[0] = fd0;
     pipefd[1] = fd1;
     return 0;
+
+bad:
+    fd_free(current->files, fd1);
+    fd_free(current->files, fd0);
+    return -1;
 }
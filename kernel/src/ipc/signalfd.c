@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "ipc/signalfd.h"
+#include "ipc/anonfd.h"
+#include "fs/vfs.h"
+#include "proc.h"
+#include "kmalloc.h"
+#include <sys/signalfd.h>
+#include <string.h>
+#include <errno.h>
+
+#define SIGNALFD_FLAGS  (SFD_NONBLOCK | SFD_CLOEXEC)
+
+/* Signals that can't be read */
+#define SIGNALFD_DENY   (((sigset_t)1 << SIGKILL) | ((sigset_t)1 << SIGSTOP))
+
+
+struct signalfd_inode {
+    struct inode base;
+    sigset_t     mask;      /**< Signals read through the descriptor */
+    int          flags;     /**< Creation flags */
+};
+
+
+static void signalfd_fill(struct signalfd_siginfo *ssi, const siginfo_t *info)
+{
+    memset(ssi, 0, sizeof(*ssi));
+    ssi->ssi_signo = info->si_signo;
+    ssi->ssi_errno = info->si_errno;
+    ssi->ssi_code = info->si_code;
+    ssi->ssi_pid = info->si_pid;
+    ssi->ssi_uid = info->si_uid;
+    ssi->ssi_int = info->si_value.sival_int;
+    ssi->ssi_ptr = (uintptr_t)info->si_value.sival_ptr;
+}
+
+/*
+ * Dequeue the reader pending signals within the mask, as many as fit in
+ * the buffer. Blocks until at least one is available.
+ */
+static int signalfd_read(struct inode *inod, void *buf,
+                         size_t count, size_t off)
+{
+    size_t n = 0;
+    siginfo_t info;
+    struct signalfd_siginfo *ssi = (struct signalfd_siginfo *)buf;
+    struct signalfd_inode *snode = (struct signalfd_inode *)inod;
+
+    if (count < sizeof(*ssi))
+        return -EINVAL;
+
+    while (sig_dequeue(current, snode->mask, &info) == 0) {
+        if ((snode->flags & SFD_NONBLOCK) != 0)
+            return -EAGAIN;
+        /* Not read signals are handled on the way back to user space */
+        if ((current->sigpend & ~current->sigmask) != 0)
+            return -EINTR;
+        current->sigwait = snode->mask;
+        current->state = TASK_SLEEPING;
+        scheduler();
+        sigemptyset(&current->sigwait);
+    }
+
+    do {
+        signalfd_fill(ssi++, &info);
+        n += sizeof(*ssi);
+    } while (n + sizeof(*ssi) <= count &&
+             sig_dequeue(current, snode->mask, &info) != 0);
+    return n;
+}
+
+static int signalfd_write(struct inode *inod, const void *buf,
+                          size_t count, size_t off)
+{
+    return -EINVAL;
+}
+
+static void signalfd_release(struct inode *inod)
+{
+    kfree(inod, sizeof(struct signalfd_inode));
+}
+
+static const struct inode_ops signalfd_ops = {
+    .read = signalfd_read,
+    .write = signalfd_write,
+    .release = signalfd_release
+};
+
+int signalfd_create(int fd, const sigset_t *mask, int flags)
+{
+    struct file *fil;
+    struct signalfd_inode *snode;
+
+    if (mask == NULL)
+        return -EFAULT;
+    if ((flags & ~SIGNALFD_FLAGS) != 0)
+        return -EINVAL;
+
+    if (fd != -1) {
+        /* Update the mask of an existing descriptor */
+        fil = fd_file(current->files, fd);
+        if (fil == NULL)
+            return -EBADF;
+        if (fil->dent->inod->ops != &signalfd_ops)
+            return -EINVAL;
+        snode = (struct signalfd_inode *)fil->dent->inod;
+        snode->mask = *mask & ~SIGNALFD_DENY;
+        return fd;
+    }
+
+    snode = (struct signalfd_inode *)kmalloc(sizeof(struct signalfd_inode), 0);
+    if (snode == NULL)
+        return -ENOMEM;
+    memset(snode, 0, sizeof(*snode));
+    snode->base.mode = S_IFIFO | S_IRUSR;
+    snode->base.ops = &signalfd_ops;
+    snode->mask = *mask & ~SIGNALFD_DENY;
+    snode->flags = flags;
+
+    fd = anonfd_create(&snode->base, flags);
+    if (fd < 0)
+        kfree(snode, sizeof(struct signalfd_inode));
+    return fd;
+}
@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#ifndef BEEOS_IPC_SIGNALFD_H_
+#define BEEOS_IPC_SIGNALFD_H_
+
+#include <signal.h>
+
+/**
+ * Create a signals notification descriptor or update its mask.
+ *
+ * @param fd        -1 to create a new descriptor or an existing signalfd.
+ * @param mask      Signals read through the descriptor.
+ * @param flags     SFD_NONBLOCK and SFD_CLOEXEC.
+ * @return          The descriptor or a negative error number.
+ */
+int signalfd_create(int fd, const sigset_t *mask, int flags);
+
+#endif /* BEEOS_IPC_SIGNALFD_H_ */
@@ -1 +1 @@
-local_sources := pipe.c
+local_sources := pipe.c anonfd.c eventfd.c signalfd.c
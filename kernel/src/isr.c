@@ -32,6 +32,25 @@ int need_resched;
 static isr_handler_t isr_handlers[HANDLERS_NUM];
 
 
+/* Pending work before returning from an interrupt */
+static void isr_exit(struct isr_frame *ifr)
+{
+    /* Preemption is disabled while holding spinlocks */
+    if (need_resched != 0 && current->preempt_count == 0) {
+        need_resched = 0;
+        scheduler();
+    }
+
+    /*
+     * Process pending signals queue.
+     * Do not handle nested signals (sfr should be null) and
+     * handle signals only before return to user code (CS check).
+     */
+    if (!sigisemptyset(&current->sigpend) &&
+            current->arch.sfr == NULL && (ifr->cs & 0x3) == 0x3)
+        do_signal();
+}
+
 /* ISR arch independent dispatcher */
 void isr_handler(struct isr_frame *ifr)
 {
@@ -48,8 +67,16 @@ void isr_handler(struct isr_frame *ifr)
     current->arch.ifr = ifr;
 
     num = ifr->int_no;
-    if (num == ISR_SYSCALL)
+    if (num == ISR_SYSCALL) {
         num = 48;
+        current->acct.nsyscalls++;
+    } else if (num == ISR_TIMER) {
+        /* Charge the tick to the interrupted mode */
+        if ((ifr->cs & 0x3) == 0x3)
+            current->acct.utime++;
+        else
+            current->acct.stime++;
+    }
 
     if (num >= HANDLERS_NUM || isr_handlers[num] == NULL)
         panic("unhandled interrupt %d\n", num);
@@ -60,24 +87,31 @@ void isr_handler(struct isr_frame *ifr)
     if (32 <= num && num <= 47)
         pic_eoi(num);
 
-    if (need_resched != 0) {
-        need_resched = 0;
-        scheduler();
-    }
-
-    /*
-     * Process pending signals queue.
-     * Do not handle nested signals (sfr should be null) and
-     * handle signals only before return to user code (CS check).
-     */
-    if (!sigisemptyset(&current->sigpend) &&
-            current->arch.sfr == NULL && (ifr->cs & 0x3) == 0x3)
-        do_signal();
+    isr_exit(ifr);
 
     /* Eventually restore the previous ifr */
     current->arch.ifr = previfr;
 }
 
+/*
+ * System call dispatcher used by the fast system call entry.
+ * The frame always comes from user mode and the handler is known.
+ */
+void isr_syscall(struct isr_frame *ifr)
+{
+    struct isr_frame *previfr;
+
+    previfr = current->arch.ifr;
+    current->arch.ifr = ifr;
+    current->acct.nsyscalls++;
+
+    isr_handlers[48]();
+
+    isr_exit(ifr);
+
+    current->arch.ifr = previfr;
+}
+
 /*
  * Registers an interrupt handler
  */
@@ -26,6 +26,8 @@
 
 void isr_handler(struct isr_frame *ifr);
 
+void isr_syscall(struct isr_frame *ifr);
+
 typedef void (*isr_handler_t)(void);
 
 void isr_register_handler(unsigned int num, isr_handler_t func);
@@ -29,6 +29,8 @@
 #include "fs/vfs.h"
 #include "fs/devfs/devfs.h"
 #include "proc/task.h"
+#include "proc/kthread.h"
+#include "sync/futex.h"
 #include "dev.h"
 
 
@@ -85,6 +87,7 @@ void kmain(void)
     timer_init();
     vfs_init();
     scheduler_init();
+    futex_init();
     tty_init();
     syscall_init();
 
@@ -98,9 +101,12 @@ void kmain(void)
             BEEOS_MAJOR, BEEOS_MINOR, BEEOS_PATCH, BEEOS_CODENAME);
 
     /* Start the init process */
-    if (task_create(init) == NULL)
+    if (task_create(init, 0) == NULL)
         panic("Unable to start init task");
 
+    /* Deferred work thread (after init, which must get pid 1) */
+    kthread_init();
+
     /* Process 0 continues with the idle procedure */
     idle();
 }
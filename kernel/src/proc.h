@@ -35,6 +35,33 @@ void scheduler(void);
 
 void scheduler_init(void);
 
+/**
+ * Disable the current task preemption.
+ * Calls can be nested, every call must be paired by preempt_enable.
+ */
+static inline void preempt_disable(void)
+{
+    current->preempt_count++;
+}
+
+/**
+ * Enable the current task preemption.
+ * A pending reschedule is served at the next interrupt return or
+ * preemption point.
+ */
+static inline void preempt_enable(void)
+{
+    current->preempt_count--;
+}
+
+/**
+ * Kernel preemption point.
+ * Long kernel paths, running with interrupts disabled, call this to let
+ * the pending interrupts be served and to eventually reschedule.
+ * No-op if the preemption is disabled.
+ */
+void preempt_point(void);
+
 /**
  * Process pending (non masked) signals.
  */
@@ -42,9 +69,10 @@ int do_signal(void);
 
 /*
  * Arch dependent return preparation from a signal handler.
+ * The handler gets the signal information if SA_SIGINFO is set.
  */
 void sigret_prepare(struct isr_frame *ifr,
-                    const struct sigaction *act, int sig);
+                    const struct sigaction *act, const siginfo_t *info);
 
 
 /*
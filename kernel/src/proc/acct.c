@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "acct.h"
+#include <string.h>
+
+#define TICK_USECS  (1000000UL / (unsigned long)CLOCKS_PER_SEC)
+
+
+void acct_add(struct task_acct *dst, const struct task_acct *src)
+{
+    dst->utime += src->utime;
+    dst->stime += src->stime;
+    dst->minflt += src->minflt;
+    dst->nvcsw += src->nvcsw;
+    dst->nivcsw += src->nivcsw;
+    dst->nsyscalls += src->nsyscalls;
+    dst->rchar += src->rchar;
+    dst->wchar += src->wchar;
+}
+
+/* 32-bit arithmetic, the 64-bit division is not available */
+static void ticks_to_timeval(clock_t ticks, struct timeval *tv)
+{
+    unsigned long t = (unsigned long)ticks;
+
+    tv->tv_sec = t / (unsigned long)CLOCKS_PER_SEC;
+    tv->tv_usec = (t % (unsigned long)CLOCKS_PER_SEC) * TICK_USECS;
+}
+
+void acct_rusage(const struct task_acct *acct, struct rusage *ru)
+{
+    memset(ru, 0, sizeof(*ru));
+    ticks_to_timeval(acct->utime, &ru->ru_utime);
+    ticks_to_timeval(acct->stime, &ru->ru_stime);
+    ru->ru_minflt = acct->minflt;
+    ru->ru_nvcsw = acct->nvcsw;
+    ru->ru_nivcsw = acct->nivcsw;
+    ru->ru_nsyscalls = acct->nsyscalls;
+    ru->ru_rchar = acct->rchar;
+    ru->ru_wchar = acct->wchar;
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Per-task resources accounting.
+ *
+ * CPU time is sampled on every clock tick and charged to the user or to
+ * the system time depending on the interrupted mode. The other counters
+ * are updated where the events happen: page faults, context switches,
+ * system calls and read/write transfers.
+ */
+
+#ifndef BEEOS_PROC_ACCT_H_
+#define BEEOS_PROC_ACCT_H_
+
+#include <time.h>
+#include <sys/resource.h>
+
+/** Resources usage counters. */
+struct task_acct {
+    clock_t         utime;      /**< User mode clock ticks */
+    clock_t         stime;      /**< Kernel mode clock ticks */
+    unsigned long   minflt;     /**< Page faults */
+    unsigned long   nvcsw;      /**< Voluntary context switches */
+    unsigned long   nivcsw;     /**< Involuntary context switches */
+    unsigned long   nsyscalls;  /**< System calls */
+    unsigned long   rchar;      /**< Bytes read */
+    unsigned long   wchar;      /**< Bytes written */
+};
+
+/**
+ * Accumulate counters (e.g. of a reaped child into its parent).
+ *
+ * @param dst   Destination counters.
+ * @param src   Added counters.
+ */
+void acct_add(struct task_acct *dst, const struct task_acct *src);
+
+/**
+ * Convert counters to the user space resources usage format.
+ *
+ * @param acct  Counters.
+ * @param ru    Resources usage.
+ */
+void acct_rusage(const struct task_acct *acct, struct rusage *ru);
+
+#endif /* BEEOS_PROC_ACCT_H_ */
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "fdtable.h"
+#include "kmalloc.h"
+#include "util.h"
+#include <errno.h>
+#include <string.h>
+
+#define MAP_SIZE(nr)    ((size_t)(nr) / 32 * sizeof(uint32_t))
+
+
+void fdtable_init(struct fdtable *fdt)
+{
+    fdt->ref = 1;
+    fdt->size = OPEN_MAX;
+    fdt->fd = fdt->fd_init;
+    fdt->map = fdt->map_init;
+    memset(fdt->fd_init, 0, sizeof(fdt->fd_init));
+    memset(fdt->map_init, 0, sizeof(fdt->map_init));
+}
+
+/*
+ * Number of slots up to the highest used descriptor.
+ */
+static int fdtable_used(const struct fdtable *fdt)
+{
+    int i;
+
+    for (i = fdt->size / 32 - 1; i >= 0; i--) {
+        if (fdt->map[i] != 0)
+            return i * 32 + fnzb(fdt->map[i]) + 1;
+    }
+    return 0;
+}
+
+struct fdtable *fdtable_dup(const struct fdtable *src)
+{
+    int i, used;
+    struct fdtable *fdt;
+
+    fdt = (struct fdtable *)kmalloc(sizeof(struct fdtable), 0);
+    if (fdt == NULL)
+        return NULL;
+    fdtable_init(fdt);
+    used = fdtable_used(src);
+    if (fdtable_grow(fdt, used) < 0) {
+        kfree(fdt, sizeof(struct fdtable));
+        return NULL;
+    }
+    /* duplicate valid file descriptors */
+    memcpy(fdt->map, src->map, MAP_SIZE(ALIGN_UP(used, 32)));
+    for (i = 0; i < used; i++) {
+        fdt->fd[i] = src->fd[i];
+        if (fdt->fd[i].fil != NULL)
+            fdt->fd[i].fil->ref++;
+    }
+    return fdt;
+}
+
+void fdtable_free(struct fdtable *fdt)
+{
+    if (fdt->fd != fdt->fd_init) {
+        kfree(fdt->fd, fdt->size * sizeof(struct filedesc));
+        kfree(fdt->map, MAP_SIZE(fdt->size));
+    }
+    kfree(fdt, sizeof(struct fdtable));
+}
+
+int fdtable_grow(struct fdtable *fdt, int nr)
+{
+    int size;
+    struct filedesc *fd;
+    uint32_t *map;
+
+    if (nr <= fdt->size)
+        return 0;
+    if (nr > FDTABLE_MAX)
+        return -EMFILE;
+    /* Double the size to amortize the copies */
+    size = MIN(MAX(ALIGN_UP(nr, 32), 2 * fdt->size), FDTABLE_MAX);
+
+    fd = (struct filedesc *)kmalloc(size * sizeof(struct filedesc), 0);
+    if (fd == NULL)
+        return -ENOMEM;
+    map = (uint32_t *)kmalloc(MAP_SIZE(size), 0);
+    if (map == NULL) {
+        kfree(fd, size * sizeof(struct filedesc));
+        return -ENOMEM;
+    }
+    memcpy(fd, fdt->fd, fdt->size * sizeof(struct filedesc));
+    memset(fd + fdt->size, 0, (size - fdt->size) * sizeof(struct filedesc));
+    memcpy(map, fdt->map, MAP_SIZE(fdt->size));
+    memset((char *)map + MAP_SIZE(fdt->size), 0,
+           MAP_SIZE(size) - MAP_SIZE(fdt->size));
+
+    if (fdt->fd != fdt->fd_init) {
+        kfree(fdt->fd, fdt->size * sizeof(struct filedesc));
+        kfree(fdt->map, MAP_SIZE(fdt->size));
+    }
+    fdt->fd = fd;
+    fdt->map = map;
+    fdt->size = size;
+    return 0;
+}
+
+/*
+ * Search the first clear bit in the map starting from the given position.
+ * A whole word is skipped at a time when it is full.
+ */
+static int fd_map_scan(const struct fdtable *fdt, int from)
+{
+    int fd = from;
+    uint32_t w;
+
+    while (fd < fdt->size) {
+        w = ~fdt->map[fd / 32] & (0xFFFFFFFF << (fd % 32));
+        if (w != 0)
+            return (fd & ~31) + fnzb(w & -w);
+        fd = (fd & ~31) + 32;
+    }
+    return -1;
+}
+
+int fd_alloc(struct fdtable *fdt, int min)
+{
+    int fd;
+
+    fd = fd_map_scan(fdt, min);
+    if (fd < 0) {
+        /* Full up to the end, the first new slot is free */
+        fd = MAX(fdt->size, min);
+        if (fdtable_grow(fdt, fd + 1) < 0)
+            return -EMFILE;
+    }
+    fdt->map[fd / 32] |= (1U << (fd % 32));
+    return fd;
+}
+
+void fd_free(struct fdtable *fdt, int fd)
+{
+    fdt->fd[fd].fil = NULL;
+    fdt->fd[fd].flags = 0;
+    fdt->map[fd / 32] &= ~(1U << (fd % 32));
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Open file descriptors table.
+ *
+ * The table is a separately allocated object, shared by the tasks created
+ * with CLONE_FILES. It starts with OPEN_MAX embedded slots and is grown
+ * on demand up to FDTABLE_MAX. A bitmap of the used slots allows to find
+ * the lowest free descriptor a word at a time.
+ */
+
+#ifndef BEEOS_PROC_FDTABLE_H_
+#define BEEOS_PROC_FDTABLE_H_
+
+#include "fs/vfs.h"
+#include <stdint.h>
+#include <limits.h>
+
+/** Maximum number of descriptors of a table (multiple of 32). */
+#define FDTABLE_MAX     1024
+
+/** Open files table. */
+struct fdtable {
+    unsigned int        ref;                    /**< Sharing tasks */
+    int                 size;                   /**< Number of slots */
+    struct filedesc     *fd;                    /**< File descriptors */
+    uint32_t            *map;                   /**< Used slots bitmap */
+    struct filedesc     fd_init[OPEN_MAX];      /**< Embedded slots */
+    uint32_t            map_init[OPEN_MAX / 32];/**< Embedded bitmap */
+};
+
+/**
+ * Initialize an empty table with the embedded slots.
+ *
+ * @param fdt   Table to initialize.
+ */
+void fdtable_init(struct fdtable *fdt);
+
+/**
+ * Allocate a copy of a table.
+ * Only the slots up to the highest used descriptor are copied and the
+ * file references are incremented.
+ *
+ * @param src   Source table.
+ * @return      New table with one reference, NULL on out of memory.
+ */
+struct fdtable *fdtable_dup(const struct fdtable *src);
+
+/**
+ * Free a table allocated by fdtable_dup.
+ * The file references are not touched.
+ *
+ * @param fdt   Table to free.
+ */
+void fdtable_free(struct fdtable *fdt);
+
+/**
+ * Grow a table to hold at least the given number of descriptors.
+ *
+ * @param fdt   Table.
+ * @param nr    Required number of slots.
+ * @return      0 on success, -EMFILE if nr exceeds FDTABLE_MAX or
+ *              -ENOMEM on out of memory.
+ */
+int fdtable_grow(struct fdtable *fdt, int nr);
+
+/**
+ * Reserve the lowest free descriptor not less than a given value.
+ * The slot is marked as used, its file shall be set by the caller.
+ *
+ * @param fdt   Table.
+ * @param min   Lowest acceptable descriptor.
+ * @return      Reserved descriptor or -EMFILE if the table is full.
+ */
+int fd_alloc(struct fdtable *fdt, int min);
+
+/**
+ * Clear a descriptor slot and mark it as free.
+ *
+ * @param fdt   Table.
+ * @param fd    Valid descriptor.
+ */
+void fd_free(struct fdtable *fdt, int fd);
+
+/**
+ * Get the file referenced by a descriptor.
+ *
+ * @param fdt   Table.
+ * @param fd    Descriptor.
+ * @return      Open file or NULL if the descriptor is not valid.
+ */
+static inline struct file *fd_file(const struct fdtable *fdt, int fd)
+{
+    return (fd >= 0 && fd < fdt->size) ? fdt->fd[fd].fil : NULL;
+}
+
+#endif /* BEEOS_PROC_FDTABLE_H_ */
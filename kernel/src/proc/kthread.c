@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "kthread.h"
+#include "proc.h"
+#include "sys.h"
+#include "panic.h"
+#include "sync/cond.h"
+#include <sched.h>
+
+/* Deferred work queue */
+static struct list_link work_queue;
+static struct cond work_cond;
+
+
+static void kthread_start(void)
+{
+    current->kthread_fn(current->kthread_arg);
+    sys_exit(0);
+}
+
+struct task *kthread_create(kthread_fn_t fn, void *arg)
+{
+    struct task *t;
+
+    t = task_create(kthread_start, CLONE_VM | CLONE_FILES | CLONE_SIGHAND);
+    if (t != NULL) {
+        /* Not yet run */
+        t->kthread_fn = fn;
+        t->kthread_arg = arg;
+    }
+    return t;
+}
+
+void work_init(struct work *work, kthread_fn_t fn, void *arg)
+{
+    list_init(&work->link);
+    work->fn = fn;
+    work->arg = arg;
+}
+
+void work_schedule(struct work *work)
+{
+    spinlock_lock(&work_cond.lock);
+    if (list_empty(&work->link)) {
+        list_insert_before(&work_queue, &work->link);
+        cond_signal(&work_cond);
+    }
+    spinlock_unlock(&work_cond.lock);
+}
+
+static void kworker(void *arg)
+{
+    struct work *work;
+
+    spinlock_lock(&work_cond.lock);
+    while (1) {
+        while (list_empty(&work_queue))
+            cond_wait(&work_cond);
+        work = list_container(work_queue.next, struct work, link);
+        list_delete(&work->link);
+        /* The item can be queued again while running */
+        spinlock_unlock(&work_cond.lock);
+        work->fn(work->arg);
+        spinlock_lock(&work_cond.lock);
+    }
+}
+
+void kthread_init(void)
+{
+    list_init(&work_queue);
+    cond_init(&work_cond);
+    if (kthread_create(kworker, NULL) == NULL)
+        panic("Unable to start the work queue thread");
+}
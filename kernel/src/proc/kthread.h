@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Kernel threads.
+ *
+ * Kernel threads run only in kernel mode sharing the task 0 address space,
+ * open files and signal handlers. The deferred work queue is served by a
+ * kernel thread and allows to postpone jobs out of interrupt handlers and
+ * system calls.
+ */
+
+#ifndef BEEOS_PROC_KTHREAD_H_
+#define BEEOS_PROC_KTHREAD_H_
+
+#include "list.h"
+
+struct task;
+
+/** Kernel thread and deferred work function. */
+typedef void (*kthread_fn_t)(void *arg);
+
+/** Deferred work item. */
+struct work {
+    struct list_link    link;   /**< Work queue link */
+    kthread_fn_t        fn;     /**< Work function */
+    void                *arg;   /**< Work function argument */
+};
+
+/**
+ * Create a kernel thread.
+ * Shall be called by task 0 or by another kernel thread. A thread that
+ * returns from its function exits and is reaped by task 0.
+ *
+ * @param fn    Thread function.
+ * @param arg   Thread function argument.
+ * @return      Thread task or NULL on failure.
+ */
+struct task *kthread_create(kthread_fn_t fn, void *arg);
+
+/**
+ * Initialize a deferred work item.
+ *
+ * @param work  Work item.
+ * @param fn    Work function.
+ * @param arg   Work function argument.
+ */
+void work_init(struct work *work, kthread_fn_t fn, void *arg);
+
+/**
+ * Queue a deferred work item, if not already queued.
+ * Can be called from interrupt handlers.
+ *
+ * @param work  Initialized work item.
+ */
+void work_schedule(struct work *work);
+
+/**
+ * Start the deferred work kernel thread.
+ */
+void kthread_init(void);
+
+#endif /* BEEOS_PROC_KTHREAD_H_ */
@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "pid.h"
+#include "task.h"
+#include "kmalloc.h"
+#include "util.h"
+#include <errno.h>
+#include <stdint.h>
+
+#define PID_HTABLE_BITS     8   /* 256 buckets */
+#define PGRP_HTABLE_BITS    6   /* 64 buckets */
+
+#define PID_MAP_WORDS       (PID_MAX / 32)
+
+/* Allocated pids bitmap */
+static uint32_t pid_map[PID_MAP_WORDS];
+/* Last allocated pid, the search starts from the next one */
+static pid_t pid_last;
+
+static struct htable_link *pid_htable[1 << PID_HTABLE_BITS];
+static struct htable_link *pgrp_htable[1 << PGRP_HTABLE_BITS];
+
+
+/*
+ * Search the first clear bit in the map starting from the given position.
+ * A whole word is skipped at a time when it is full.
+ */
+static pid_t pid_map_scan(pid_t from, pid_t to)
+{
+    pid_t pid = from;
+    uint32_t w;
+
+    while (pid < to) {
+        w = ~pid_map[pid / 32] & (0xFFFFFFFF << (pid % 32));
+        if (w != 0) {
+            pid = (pid & ~31) + fnzb(w & -w);
+            return (pid < to) ? pid : -1;
+        }
+        pid = (pid & ~31) + 32;
+    }
+    return -1;
+}
+
+pid_t pid_alloc(void)
+{
+    pid_t pid, start;
+
+    start = pid_last + 1;
+    if (start >= PID_MAX)
+        start = 1;
+    pid = start;
+    do {
+        pid = pid_map_scan(pid, PID_MAX);
+        if (pid < 0)
+            pid = pid_map_scan(1, start);
+        if (pid < 0)
+            return -EAGAIN;
+        if (pgrp_find(pid) == NULL) {
+            pid_map[pid / 32] |= (1U << (pid % 32));
+            pid_last = pid;
+            return pid;
+        }
+        /* Still used as a process group identifier */
+        pid++;
+        if (pid >= PID_MAX)
+            pid = 1;
+    } while (pid != start);
+    return -EAGAIN;
+}
+
+void pid_free(pid_t pid)
+{
+    pid_map[pid / 32] &= ~(1U << (pid % 32));
+}
+
+void pid_hash(struct task *t)
+{
+    htable_insert(pid_htable, &t->hlink, t->pid, PID_HTABLE_BITS);
+}
+
+void pid_unhash(struct task *t)
+{
+    htable_delete(&t->hlink);
+}
+
+struct task *task_find(pid_t pid)
+{
+    struct task *t;
+    struct htable_link *lnk;
+
+    lnk = htable_lookup(pid_htable, pid, PID_HTABLE_BITS);
+    while (lnk != NULL) {
+        t = struct_ptr(lnk, struct task, hlink);
+        if (t->pid == pid)
+            return t;
+        lnk = lnk->next;
+    }
+    return NULL;
+}
+
+struct pgrp *pgrp_find(pid_t pgid)
+{
+    struct pgrp *pg;
+    struct htable_link *lnk;
+
+    lnk = htable_lookup(pgrp_htable, pgid, PGRP_HTABLE_BITS);
+    while (lnk != NULL) {
+        pg = struct_ptr(lnk, struct pgrp, hlink);
+        if (pg->pgid == pgid)
+            return pg;
+        lnk = lnk->next;
+    }
+    return NULL;
+}
+
+int pgrp_join(struct task *t, pid_t pgid)
+{
+    struct pgrp *pg;
+
+    if (t->pgrp != NULL && t->pgrp->pgid == pgid)
+        return 0;
+
+    pg = pgrp_find(pgid);
+    if (pg == NULL) {
+        pg = (struct pgrp *)kmalloc(sizeof(struct pgrp), 0);
+        if (pg == NULL)
+            return -ENOMEM;
+        pg->pgid = pgid;
+        list_init(&pg->members);
+        htable_insert(pgrp_htable, &pg->hlink, pgid, PGRP_HTABLE_BITS);
+    }
+    pgrp_leave(t);
+    list_insert_before(&pg->members, &t->pglink);
+    t->pgrp = pg;
+    t->pgid = pgid;
+    return 0;
+}
+
+void pgrp_leave(struct task *t)
+{
+    struct pgrp *pg = t->pgrp;
+
+    if (pg == NULL)
+        return;
+    list_delete(&t->pglink);
+    t->pgrp = NULL;
+    if (list_empty(&pg->members)) {
+        htable_delete(&pg->hlink);
+        kfree(pg, sizeof(struct pgrp));
+    }
+}
+
+int pgrp_signal(pid_t pgid, const siginfo_t *info)
+{
+    struct pgrp *pg;
+    struct list_link *lnk, *next;
+
+    pg = pgrp_find(pgid);
+    if (pg == NULL)
+        return -ESRCH;
+    if (info->si_signo != 0) {
+        lnk = pg->members.next;
+        while (lnk != &pg->members) {
+            next = lnk->next;
+            (void)task_sigqueue(list_container(lnk, struct task, pglink),
+                                info);
+            lnk = next;
+        }
+    }
+    return 0;
+}
+
+void pid_init(void)
+{
+    htable_init(pid_htable, PID_HTABLE_BITS);
+    htable_init(pgrp_htable, PGRP_HTABLE_BITS);
+    /* Pid 0 is reserved to the kernel task */
+    pid_map[0] = 1;
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Process identifiers management.
+ *
+ * Live tasks are indexed by pid in a hash table and every task is linked
+ * to the list of its process group, thus lookups by pid or by group do not
+ * depend on the number of processes in the system.
+ */
+
+#ifndef BEEOS_PROC_PID_H_
+#define BEEOS_PROC_PID_H_
+
+#include "list.h"
+#include "htable.h"
+#include <sys/types.h>
+#include <signal.h>
+
+/** Maximum process identifier value (exclusive). */
+#define PID_MAX     32768
+
+struct task;
+
+/** Process group. */
+struct pgrp {
+    pid_t               pgid;       /**< Process group ID */
+    struct list_link    members;    /**< Member tasks list */
+    struct htable_link  hlink;      /**< Process groups hash table link */
+};
+
+/**
+ * Initialize the pid allocator and the lookup tables.
+ */
+void pid_init(void);
+
+/**
+ * Allocate a process identifier.
+ * Identifiers are handed out cyclically starting after the last allocated
+ * one, thus a freed pid is not immediately reused. Values that are still
+ * in use as process group identifiers are skipped.
+ *
+ * @return  A free pid or -EAGAIN if the pid space is exhausted.
+ */
+pid_t pid_alloc(void);
+
+/**
+ * Release a process identifier.
+ *
+ * @param pid   Identifier previously returned by pid_alloc.
+ */
+void pid_free(pid_t pid);
+
+/**
+ * Insert a task in the pid hash table.
+ *
+ * @param t     Task with a valid pid.
+ */
+void pid_hash(struct task *t);
+
+/**
+ * Remove a task from the pid hash table.
+ *
+ * @param t     Hashed task.
+ */
+void pid_unhash(struct task *t);
+
+/**
+ * Find a process group by identifier.
+ *
+ * @param pgid  Process group identifier.
+ * @return      Process group or NULL if there are no members.
+ */
+struct pgrp *pgrp_find(pid_t pgid);
+
+/**
+ * Move a task to a process group, the group is created if required.
+ * The previous group is released if it is left empty.
+ *
+ * @param t     Task.
+ * @param pgid  Process group identifier.
+ * @return      0 on success or -ENOMEM.
+ */
+int pgrp_join(struct task *t, pid_t pgid);
+
+/**
+ * Remove a task from its process group.
+ *
+ * @param t     Task.
+ */
+void pgrp_leave(struct task *t);
+
+/**
+ * Send a signal to all the members of a process group.
+ *
+ * @param pgid  Process group identifier.
+ * @param info  Signal information (si_signo 0 to check only for the group
+ *              existence).
+ * @return      0 on success or -ESRCH if the group does not exist.
+ */
+int pgrp_signal(pid_t pgid, const siginfo_t *info);
+
+#endif /* BEEOS_PROC_PID_H_ */
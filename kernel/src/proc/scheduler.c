@@ -23,39 +23,26 @@
 #include "timer.h"
 #include "kmalloc.h"
 #include "panic.h"
+#include "arch/x86/misc.h"
 
 
 struct task ktask;
 struct task *current = &ktask;
 
 
-static int sigpop(sigset_t *sigpend, const sigset_t *sigmask)
-{
-    int sig;
-
-    /* find first non blocked signal */
-    for (sig = 0; sig < SIGNALS_NUM; sig++) {
-        if (sigismember(sigpend, sig) == 1 && sigismember(sigmask, sig) <= 0)
-            break;
-    }
-    if (sig == SIGNALS_NUM)
-        return -1;
-    sigdelset(sigpend, sig);
-    return sig;
-}
-
-
 int do_signal(void)
 {
     int sig;
     struct isr_frame *ifr;
     const struct sigaction *act;
+    siginfo_t info;
 
-    sig = sigpop(&current->sigpend, &current->sigmask);
+    /* Lowest non blocked signal */
+    sig = sig_dequeue(current, ~current->sigmask, &info);
     if (sig <= 0)
         return -1; /* no unmasked signals available */
     ifr = current->arch.ifr;
-    act = &current->signals[sig - 1];
+    act = &current->sighand->action[sig - 1];
 
     if (act->sa_handler == SIG_DFL) {
         if (sig == SIGCHLD || sig == SIGURG)
@@ -79,7 +66,7 @@ int do_signal(void)
         memcpy(current->arch.sfr, ifr, sizeof(*ifr));
     }
 
-    sigret_prepare(ifr, act, sig);
+    sigret_prepare(ifr, act, &info);
 
     return 0;
 }
@@ -107,9 +94,16 @@ void scheduler(void)
     /* Update CPU usage statistics */
     current->usage += (timer_ticks - prev_clock);
     prev_clock = timer_ticks;
+    if (next != curr) {
+        if (curr->state == TASK_RUNNING)
+            curr->acct.nivcsw++;    /* Preempted */
+        else
+            curr->acct.nvcsw++;     /* Gone to sleep or exited */
+    }
 
     current = next;
     current->counter = msecs_to_ticks(SCHED_TIMESLICE);
+    timepage_switch(current->usage);
 
     /*
      * Should be the last call... the following can return in another place.
@@ -118,6 +112,25 @@ void scheduler(void)
     task_arch_switch(&curr->arch, &next->arch);
 }
 
+void preempt_point(void)
+{
+    if (current->preempt_count != 0)
+        return;
+
+    /* Rescheduling is done on interrupt return */
+    irq_window();
+
+    /* Requested while the preemption was disabled */
+    if (need_resched != 0) {
+        need_resched = 0;
+        scheduler();
+    }
+}
+
+/* Task 0 open files and signal handlers tables */
+static struct fdtable ktask_files;
+static struct sighand ktask_sighand = { .ref = 1 };
+
 void scheduler_init(void)
 {
     int i;
@@ -129,20 +142,33 @@ void scheduler_init(void)
     ktask.cwd = NULL;
     ktask.state = TASK_RUNNING;
     ktask.brk = 0;
+    strcpy(ktask.comm, "kernel");
+    fdtable_init(&ktask_files);
+    ktask.files = &ktask_files;
+    ktask.sighand = &ktask_sighand;
     ktask.pptr = &ktask;
     list_init(&ktask.tasks);
     list_init(&ktask.sibling);
     list_init(&ktask.children);
+    list_init(&ktask.zombies);
     list_init(&ktask.condw);
+    list_init(&ktask.sigqueue);
     list_init(&ktask.timers);
-    if (task_arch_init(&ktask.arch, NULL) < 0)
+    task_cache_init();
+    if (task_arch_init(&ktask.arch, NULL, 0) < 0)
         panic("Task 0 init failure");
 
+    pid_init();
+    list_init(&ktask.pglink);
+    if (pgrp_join(&ktask, 0) < 0)
+        panic("Task 0 process group");
+    pid_hash(&ktask);
+
     sigemptyset(&ktask.sigmask);
     sigemptyset(&ktask.sigpend);
     for (i = 0; i < SIGNALS_NUM; i++) {
-        memset(&ktask.signals[i], 0, sizeof(struct sigaction));
-        ktask.signals[i].sa_handler = SIG_DFL;
+        memset(&ktask.sighand->action[i], 0, sizeof(struct sigaction));
+        ktask.sighand->action[i].sa_handler = SIG_DFL;
     }
 }
 
@@ -169,25 +195,24 @@ static void task_dump(const struct task *t)
 }
 
 
-static void proc_dump_p(struct task *t, int level,
-        struct task *fs, struct task *fp)
+static void proc_dump_p(const struct task *t, int level)
 {
     int i;
-    struct task *s;
+    const struct list_link *lnk;
 
     for (i = 0; i < level; i++)
         kprintf(" ");
     task_dump(t);
     kprintf("\n");
-    s = struct_ptr(t->sibling.next, struct task, sibling);
-    if (s != fs)
-        proc_dump_p(s, level, fs, s);
-    t = struct_ptr(t->children.next, struct task, children);
-    if (t != fp)
-        proc_dump_p(t, level + 1, t, fp);
+    for (lnk = t->children.next; lnk != &t->children; lnk = lnk->next)
+        proc_dump_p(list_container_const(lnk, struct task, sibling),
+                    level + 1);
+    for (lnk = t->zombies.next; lnk != &t->zombies; lnk = lnk->next)
+        proc_dump_p(list_container_const(lnk, struct task, sibling),
+                    level + 1);
 }
 
 void proc_dump(void)
 {
-    proc_dump_p(&ktask, 0, &ktask, &ktask);
+    proc_dump_p(&ktask, 0);
 }
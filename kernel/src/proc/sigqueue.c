@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "sigqueue.h"
+#include "proc.h"
+#include "mm/slab.h"
+#include "arch/x86/misc.h"
+#include <string.h>
+#include <errno.h>
+
+static struct slab_cache sigqueue_cache;
+
+
+/*
+ * Lowest signal number in a non empty set.
+ */
+static int sig_first(sigset_t set)
+{
+    uint32_t lo = (uint32_t)set;
+
+    return (lo != 0) ? bsf(lo) : 32 + bsf((uint32_t)(set >> 32));
+}
+
+int task_sigqueue(struct task *tsk, const siginfo_t *info)
+{
+    int sig = info->si_signo;
+    struct sigqueue *q = NULL;
+
+    /* Standard signals do not queue */
+    if (sig < SIGRTMIN && sigismember(&tsk->sigpend, sig) > 0)
+        return 0;
+
+    if (tsk->sigqueued < SIGQUEUE_MAX)
+        q = (struct sigqueue *)slab_cache_alloc(&sigqueue_cache, 0);
+    if (q != NULL) {
+        q->info = *info;
+        list_insert_before(&tsk->sigqueue, &q->link);
+        tsk->sigqueued++;
+    } else if (sig >= SIGRTMIN) {
+        return -EAGAIN;
+    }
+    /* A standard signal without entry is delivered with a generic info */
+    (void)sigaddset(&tsk->sigpend, sig);
+
+    /* check if the process must be awake */
+    if ((sigismember(&tsk->sigmask, sig) <= 0 ||
+         sigismember(&tsk->sigwait, sig) > 0) &&
+        tsk->state == TASK_SLEEPING) {
+        if (!list_empty(&tsk->condw))
+            list_delete(&tsk->condw);
+        tsk->state = TASK_RUNNING;
+    }
+    return 0;
+}
+
+int sig_dequeue(struct task *tsk, sigset_t set, siginfo_t *info)
+{
+    int sig, more = 0;
+    struct list_link *lnk;
+    struct sigqueue *q, *found = NULL;
+
+    set &= tsk->sigpend;
+    if (set == 0)
+        return 0;
+    sig = sig_first(set);
+
+    for (lnk = tsk->sigqueue.next; lnk != &tsk->sigqueue; lnk = lnk->next) {
+        q = list_container(lnk, struct sigqueue, link);
+        if (q->info.si_signo != sig)
+            continue;
+        if (found != NULL) {
+            more = 1;
+            break;
+        }
+        found = q;
+    }
+
+    if (found != NULL) {
+        *info = found->info;
+        list_delete(&found->link);
+        slab_cache_free(&sigqueue_cache, found);
+        tsk->sigqueued--;
+    } else {
+        memset(info, 0, sizeof(*info));
+        info->si_signo = sig;
+        info->si_code = SI_KERNEL;
+    }
+    if (more == 0)
+        (void)sigdelset(&tsk->sigpend, sig);
+    return sig;
+}
+
+void sigqueue_flush(struct task *tsk)
+{
+    struct sigqueue *q;
+
+    while (!list_empty(&tsk->sigqueue)) {
+        q = list_container(tsk->sigqueue.next, struct sigqueue, link);
+        list_delete(&q->link);
+        slab_cache_free(&sigqueue_cache, q);
+    }
+    tsk->sigqueued = 0;
+    sigemptyset(&tsk->sigpend);
+}
+
+void sigqueue_init(void)
+{
+    slab_cache_init(&sigqueue_cache, "sigqueue-cache",
+            sizeof(struct sigqueue), 0, 0, NULL, NULL);
+}
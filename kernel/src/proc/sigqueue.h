@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Queued signals.
+ *
+ * Every sent signal carries a siginfo payload queued to the target task.
+ * Standard signals are pending at most once, further instances are
+ * discarded. Real-time signals are queued up to SIGQUEUE_MAX entries per
+ * task, thus none is lost. Pending signals are delivered lowest number
+ * first, entries of the same signal in sending order.
+ */
+
+#ifndef BEEOS_PROC_SIGQUEUE_H_
+#define BEEOS_PROC_SIGQUEUE_H_
+
+#include "list.h"
+#include <signal.h>
+
+/** Maximum number of queued signals per task. */
+#define SIGQUEUE_MAX    64
+
+struct task;
+
+/** Queued signal. */
+struct sigqueue {
+    struct list_link    link;   /**< Task signals queue link */
+    siginfo_t           info;   /**< Signal information */
+};
+
+/**
+ * Initialize the queued signals cache.
+ */
+void sigqueue_init(void);
+
+/**
+ * Send a signal to a task.
+ * The task is woken up if the signal is not blocked or if it is waiting
+ * for it within sigtimedwait.
+ *
+ * @param tsk   Target task.
+ * @param info  Signal information (si_signo shall be a valid signal).
+ * @return      0 on success or -EAGAIN if a real-time signal can't be
+ *              queued.
+ */
+int task_sigqueue(struct task *tsk, const siginfo_t *info);
+
+/**
+ * Remove the lowest pending signal within a set.
+ *
+ * @param tsk   Task.
+ * @param set   Accepted signals.
+ * @param info  Filled with the signal information.
+ * @return      Signal number or 0 if none is pending.
+ */
+int sig_dequeue(struct task *tsk, sigset_t set, siginfo_t *info);
+
+/**
+ * Discard all the pending signals of a task.
+ *
+ * @param tsk   Task.
+ */
+void sigqueue_flush(struct task *tsk);
+
+#endif /* BEEOS_PROC_SIGQUEUE_H_ */
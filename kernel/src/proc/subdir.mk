@@ -1 +1 @@
-local_sources := scheduler.c task.c
+local_sources := scheduler.c task.c pid.c kthread.c fdtable.c sigqueue.c acct.c
@@ -22,34 +22,138 @@
 #include "fs/vfs.h"
 #include "timer.h"
 #include "kmalloc.h"
+#include "mm/slab.h"
 #include "panic.h"
 #include <string.h>
+#include <sched.h>
+#include <errno.h>
 
 
 void task_signal(struct task *tsk, int sig)
 {
-    sigaddset(&tsk->sigpend, sig);
-
-    /* check if signal is not masked */
-    if (sigismember(&tsk->sigmask, sig) <= 0) {
-        /* check if the process must be awake */
-        if (tsk->state == TASK_SLEEPING) {
-            if (!list_empty(&tsk->condw))
-                list_delete(&tsk->condw);
-            tsk->state = TASK_RUNNING;
-        }
+    siginfo_t info;
+
+    memset(&info, 0, sizeof(info));
+    info.si_signo = sig;
+    info.si_code = SI_KERNEL;
+    (void)task_sigqueue(tsk, &info);
+}
+
+void task_vfork_done(struct task *tsk)
+{
+    struct task *parent = tsk->pptr;
+
+    if (tsk->vfork == 0)
+        return;
+    spinlock_lock(&parent->chld_exit.lock);
+    tsk->vfork = 0;
+    cond_signal(&parent->chld_exit);
+    spinlock_unlock(&parent->chld_exit.lock);
+}
+
+/* Task structures cache */
+static struct slab_cache task_cache;
+
+
+/*
+ * Task structure constructor.
+ * Lists and condition variables are released in their initial state when
+ * the task is deleted, thus are initialized only once per object.
+ */
+static void task_ctor(void *obj)
+{
+    struct task *tsk = (struct task *)obj;
+
+    memset(tsk, 0, sizeof(*tsk));
+    list_init(&tsk->pglink);
+    list_init(&tsk->tasks);
+    list_init(&tsk->children);
+    list_init(&tsk->zombies);
+    list_init(&tsk->sibling);
+    list_init(&tsk->timers);
+    list_init(&tsk->condw);
+    list_init(&tsk->sigqueue);
+    cond_init(&tsk->chld_exit);
+}
+
+static struct sighand *sighand_dup(const struct sighand *src)
+{
+    struct sighand *sh;
+
+    sh = (struct sighand *)kmalloc(sizeof(struct sighand), 0);
+    if (sh != NULL) {
+        memcpy(sh->action, src->action, sizeof(sh->action));
+        sh->ref = 1;
     }
+    return sh;
 }
 
-int task_init(struct task *tsk, task_entry_t entry)
+static void sighand_put(struct task *tsk)
+{
+    if (tsk->sighand != NULL && --tsk->sighand->ref == 0)
+        kfree(tsk->sighand, sizeof(struct sighand));
+    tsk->sighand = NULL;
+}
+
+void task_files_put(struct task *tsk)
+{
+    if (tsk->files != NULL && --tsk->files->ref == 0)
+        fdtable_free(tsk->files);
+    tsk->files = NULL;
+}
+
+int task_unshare(struct task *tsk)
+{
+    struct fdtable *fdt;
+    struct sighand *sh;
+
+    if (tsk->files->ref > 1) {
+        fdt = fdtable_dup(tsk->files);
+        if (fdt == NULL)
+            return -ENOMEM;
+        tsk->files->ref--;
+        tsk->files = fdt;
+    }
+    if (tsk->sighand->ref > 1) {
+        sh = sighand_dup(tsk->sighand);
+        if (sh == NULL)
+            return -ENOMEM;
+        tsk->sighand->ref--;
+        tsk->sighand = sh;
+    }
+    return 0;
+}
+
+/*
+ * Release the open files of a task that never run.
+ */
+static void files_release(struct task *tsk)
 {
-    static pid_t next_pid = 1;
     int i;
-    struct task *sib;
+
+    if (tsk->files->ref == 1) {
+        for (i = 0; i < tsk->files->size; i++) {
+            if (tsk->files->fd[i].fil != NULL)
+                tsk->files->fd[i].fil->ref--;
+        }
+    }
+    task_files_put(tsk);
+}
+
+int task_init(struct task *tsk, task_entry_t entry, unsigned int flags)
+{
+    int ret;
 
     /* pids */
-    tsk->pid = next_pid++;
-    tsk->pgid = current->pgid;
+    tsk->pid = pid_alloc();
+    if (tsk->pid < 0)
+        return tsk->pid;
+    tsk->pgrp = NULL;
+    ret = pgrp_join(tsk, current->pgid);
+    if (ret < 0) {
+        pid_free(tsk->pid);
+        return ret;
+    }
     tsk->pptr = current;
 
     /* user and group */
@@ -64,12 +168,27 @@ int task_init(struct task *tsk, task_entry_t entry)
     tsk->cwd = ddup(current->cwd);
     tsk->root = ddup(current->root);
 
-    /* duplicate valid file descriptors */
-    memset(tsk->fds, 0, sizeof(tsk->fds));
-    for (i = 0; i < OPEN_MAX; i++) {
-        if (current->fds[i].fil != NULL) {
-            tsk->fds[i] = current->fds[i];
-            tsk->fds[i].fil->ref++;
+    /* open files */
+    if ((flags & CLONE_FILES) != 0) {
+        tsk->files = current->files;
+        tsk->files->ref++;
+    } else {
+        tsk->files = fdtable_dup(current->files);
+        if (tsk->files == NULL) {
+            ret = -ENOMEM;
+            goto bad_files;
+        }
+    }
+
+    /* signal handlers */
+    if ((flags & CLONE_SIGHAND) != 0) {
+        tsk->sighand = current->sighand;
+        tsk->sighand->ref++;
+    } else {
+        tsk->sighand = sighand_dup(current->sighand);
+        if (tsk->sighand == NULL) {
+            ret = -ENOMEM;
+            goto bad_sighand;
         }
     }
 
@@ -78,60 +197,89 @@ int task_init(struct task *tsk, task_entry_t entry)
 
     /* sheduler */
     tsk->usage = 0;
+    memset(&tsk->acct, 0, sizeof(tsk->acct));
+    memset(&tsk->cacct, 0, sizeof(tsk->cacct));
+    memcpy(tsk->comm, current->comm, sizeof(tsk->comm));
     tsk->state = TASK_RUNNING;
     tsk->counter = msecs_to_ticks(SCHED_TIMESLICE);
     tsk->exit_code = 0;
+    tsk->vfork = ((flags & CLONE_VFORK) != 0);
+    tsk->preempt_count = 0;
 
-    list_init(&tsk->tasks);
-    list_init(&tsk->children);
-    list_init(&tsk->sibling);
+    /*
+     * Architecture specific initialization can be preempted, thus is done
+     * before the task becomes reachable by the scheduler.
+     */
+    ret = task_arch_init(&tsk->arch, entry, flags);
+    if (ret < 0)
+        goto bad_arch;
 
-    /* Add to the global tasks list */
+    /* Add to the global tasks list and make it reachable by pid */
     list_insert_before(&current->tasks, &tsk->tasks);
+    pid_hash(tsk);
 
-    sib = list_container(current->children.next, struct task, children);
-    if (list_empty(&current->children) || sib->pptr != current)
-        list_insert_after(&current->children, &tsk->children);
-    else
-        list_insert_before(&sib->sibling, &tsk->sibling);
-
-    cond_init(&tsk->chld_exit);
+    /* Add to the parent children list */
+    list_insert_before(&current->children, &tsk->sibling);
 
     /* signals */
     sigemptyset(&tsk->sigpend);
     sigemptyset(&tsk->sigmask);
-    memcpy(tsk->signals, current->signals, sizeof(tsk->signals));
+    sigemptyset(&tsk->sigwait);
+    tsk->sigqueued = 0;
 
-    /* Timers events */
-    list_init(&tsk->timers);
+    /*
+     * Timers events, the alarm is initialized on first use.
+     * The slab object may come from a previous task, nothing is inherited.
+     */
+    memset(&tsk->alarm, 0, sizeof(tsk->alarm));
 
-    /* Conditional wait link */
-    list_init(&tsk->condw);
+    /* Futex wait key */
+    memset(&tsk->futex, 0, sizeof(tsk->futex));
+
+    /* Kernel thread entry, set by the creator */
+    tsk->kthread_fn = NULL;
+    tsk->kthread_arg = NULL;
 
     /* Controlling terminal */
     tsk->tty = current->tty;
 
-    return task_arch_init(&tsk->arch, entry);
+    return 0;
+
+bad_arch:
+    sighand_put(tsk);
+bad_sighand:
+    files_release(tsk);
+bad_files:
+    dput(tsk->cwd);
+    dput(tsk->root);
+    pgrp_leave(tsk);
+    pid_free(tsk->pid);
+    return ret;
 }
 
 
 void task_deinit(struct task *tsk)
 {
+    pid_unhash(tsk);
+    pgrp_leave(tsk);
+    pid_free(tsk->pid);
+    task_files_put(tsk);
+    sighand_put(tsk);
+    sigqueue_flush(tsk);
     dput(tsk->cwd);
     dput(tsk->root);
     task_arch_deinit(&tsk->arch);
 }
 
 
-struct task *task_create(task_entry_t entry)
+struct task *task_create(task_entry_t entry, unsigned int flags)
 {
     struct task *tsk;
 
-    tsk = (struct task *)kmalloc(sizeof(struct task), 0);
+    tsk = (struct task *)slab_cache_alloc(&task_cache, 0);
     if (tsk != NULL) {
-        memset(tsk, 0, sizeof(*tsk));
-        if (task_init(tsk, entry) < 0) {
-            kfree(tsk, sizeof(struct task));
+        if (task_init(tsk, entry, flags) < 0) {
+            slab_cache_free(&task_cache, tsk);
             tsk = NULL;
         }
     }
@@ -142,5 +290,13 @@ struct task *task_create(task_entry_t entry)
 void task_delete(struct task *tsk)
 {
     task_deinit(tsk);
-    kfree(tsk, sizeof(struct task));
+    slab_cache_free(&task_cache, tsk);
+}
+
+
+void task_cache_init(void)
+{
+    sigqueue_init();
+    slab_cache_init(&task_cache, "task-cache", sizeof(struct task),
+            0, 0, task_ctor, NULL);
 }
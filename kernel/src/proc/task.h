@@ -21,26 +21,42 @@
 #define BEEOS_PROC_TASK_H_
 
 #include "list.h"
+#include "proc/pid.h"
+#include "proc/kthread.h"
+#include "proc/fdtable.h"
+#include "proc/sigqueue.h"
+#include "proc/acct.h"
 #include "fs/vfs.h"
 #include "sync/cond.h"
+#include "sync/futex.h"
 #include "timer.h"
 #include <stdint.h>
 #include <limits.h>
 #include <sys/types.h>
 #include <signal.h>
+#include <sys/procinfo.h>
 #include "arch/x86/task.h"
 
 #define TASK_RUNNING    1
 #define TASK_SLEEPING   2
 #define TASK_ZOMBIE     3
 
-#define SIGNALS_NUM     (SIGUNUSED+1)
+#define SIGNALS_NUM     NSIG
+
+/** Signal actions table, shared by the tasks created with CLONE_SIGHAND. */
+struct sighand {
+    unsigned int        ref;                    /**< Sharing tasks */
+    struct sigaction    action[SIGNALS_NUM];    /**< Signal handlers */
+};
 
 /** Process structure. */
 struct task {
     struct task_arch    arch;           /**< Architecture specific data. */
     pid_t               pid;            /**< Process ID. */
     pid_t               pgid;           /**< Process group ID */
+    struct htable_link  hlink;          /**< Pid hash table link */
+    struct pgrp         *pgrp;          /**< Process group */
+    struct list_link    pglink;         /**< Process group members link */
     uid_t               uid;            /**< Real user ID. */
     uid_t               euid;           /**< Effective user ID. */
     uid_t               suid;           /**< Saved used ID. */
@@ -50,43 +66,118 @@ struct task {
     int                 state;          /**< Process state. */
     struct dentry       *cwd;           /**< Current working directory. */
     struct dentry       *root;          /**< File system root. */
-    struct filedesc     fds[OPEN_MAX];  /**< Open files. */
+    struct fdtable      *files;         /**< Open files. */
     struct list_link    tasks;          /**< Tasks list link. */
     struct cond         chld_exit;      /**< Child exit condition */
     int                 counter;        /**< Remaining time slice for sched */
+    int                 preempt_count;  /**< Preemption disable nesting */
     int                 exit_code;      /**< Exit status */
+    int                 vfork;          /**< Parent suspended by vfork */
     struct task         *pptr;          /**< Parent process */
-    struct list_link    children;       /**< Children list (vertical) */
-    struct list_link    sibling;        /**< Siblings list (horizontal) */
+    struct list_link    children;       /**< Running children list */
+    struct list_link    zombies;        /**< Terminated children queue */
+    struct list_link    sibling;        /**< Parent children/zombies link */
     uintptr_t           brk;            /**< Program break */
     sigset_t            sigpend;        /**< Pending signals */
     sigset_t            sigmask;        /**< Masked */
-    struct sigaction    signals[SIGNALS_NUM];   /**< Signal handlers */
+    sigset_t            sigwait;        /**< Waited by sigtimedwait */
+    struct list_link    sigqueue;       /**< Queued signals information */
+    unsigned int        sigqueued;      /**< Queued signals number */
+    struct sighand      *sighand;       /**< Signal handlers */
     struct list_link    timers;         /**< Process running timer events */
     struct timer_event  alarm;          /**< Alarm timer event (pre-allocated) */
     struct list_link    condw;          /**< Conditional wait */
+    struct futex_key    futex;          /**< Futex waited for */
     dev_t               tty;            /**< Controlling terminal */
     clock_t             usage;          /**< CPU time in clock ticks */
+    struct task_acct    acct;           /**< Resources usage */
+    struct task_acct    cacct;          /**< Waited children resources usage */
+    char                comm[PROC_COMM_LEN]; /**< Command name */
+    kthread_fn_t        kthread_fn;     /**< Kernel thread function */
+    void                *kthread_arg;   /**< Kernel thread argument */
 };
 
 
 typedef void (* task_entry_t)(void);
 
-int task_init(struct task *tsk, task_entry_t entry);
+int task_init(struct task *tsk, task_entry_t entry, unsigned int flags);
 
 void task_deinit(struct task *tsk);
 
-struct task *task_create(task_entry_t entry);
+/**
+ * Release the task reference to its open files table.
+ * The table is freed by the last user, its files shall be already closed.
+ *
+ * @param tsk   Task.
+ */
+void task_files_put(struct task *tsk);
+
+/**
+ * Give the task private copies of its shared files and signal tables.
+ *
+ * @param tsk   Task.
+ * @return      0 on success or -ENOMEM.
+ */
+int task_unshare(struct task *tsk);
+
+/**
+ * Create a new task as a copy of the current one.
+ *
+ * @param entry     Kernel entry point of the new task.
+ * @param flags     Creation flags (CLONE_VM, CLONE_VFORK).
+ * @return          The new task or NULL on failure.
+ */
+struct task *task_create(task_entry_t entry, unsigned int flags);
 
 void task_delete(struct task *tsk);
 
 void task_signal(struct task *tsk, int sig);
 
+/**
+ * Resume the parent suspended by vfork.
+ * Called when a vfork child stops using the parent address space,
+ * that is on successful exec or on exit.
+ *
+ * @param tsk   Task (nothing is done if it was not created by vfork).
+ */
+void task_vfork_done(struct task *tsk);
+
+/**
+ * Find a task by process identifier.
+ *
+ * @param pid   Process identifier.
+ * @return      Task pointer or NULL if not found.
+ */
+struct task *task_find(pid_t pid);
+
+/**
+ * Initialize the task structures and kernel stacks caches.
+ */
+void task_cache_init(void);
+
 
-int task_arch_init(struct task_arch *tsk, task_entry_t entry);
+int task_arch_init(struct task_arch *tsk, task_entry_t entry,
+                   unsigned int flags);
+
+/**
+ * Release the task reference to its page directory.
+ * The directory and the user space are freed by the last user.
+ *
+ * @param tsk   Architecture specific task data.
+ */
+void task_arch_pgdir_put(struct task_arch *tsk);
 
 void task_arch_deinit(struct task_arch *tsk);
 
+/**
+ * Set the user stack pointer the task returns to user space with.
+ * Valid only for tasks created while the parent was in a system call.
+ *
+ * @param tsk   Architecture specific task data.
+ * @param sp    User stack pointer.
+ */
+void task_arch_ustack(struct task_arch *tsk, uintptr_t sp);
+
 void task_arch_switch(struct task_arch *curr, const struct task_arch *next);
 
 
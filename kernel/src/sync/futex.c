@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "futex.h"
+#include "cond.h"
+#include "proc.h"
+#include "htable.h"
+#include <errno.h>
+
+#define FUTEX_HTABLE_BITS   6   /* 64 wait queues */
+
+/*
+ * Wait queues table. Futexes hashing to the same queue share it, the
+ * waiters are told apart by the key stored in the task.
+ */
+static struct cond futex_table[1 << FUTEX_HTABLE_BITS];
+
+
+static struct cond *futex_queue(uint32_t space, uintptr_t addr)
+{
+    return &futex_table[hash_32(space ^ addr, FUTEX_HTABLE_BITS)];
+}
+
+int futex_wait(int *uaddr, int val)
+{
+    struct cond *q;
+    int ret = 0;
+
+    q = futex_queue(current->arch.pgdir, (uintptr_t)uaddr);
+    spinlock_lock(&q->lock);
+    if (*uaddr != val) {
+        ret = -EAGAIN;
+    } else {
+        current->futex.space = current->arch.pgdir;
+        current->futex.addr = (uintptr_t)uaddr;
+        cond_wait(q);
+        /* The key is cleared by the waker, still set if signaled */
+        if (current->futex.addr != 0) {
+            current->futex.addr = 0;
+            ret = -EINTR;
+        }
+    }
+    spinlock_unlock(&q->lock);
+    return ret;
+}
+
+int futex_wake(const int *uaddr, int count)
+{
+    struct cond *q;
+    struct list_link *lnk, *next;
+    struct task *t;
+    uint32_t space = current->arch.pgdir;
+    int n = 0;
+
+    q = futex_queue(space, (uintptr_t)uaddr);
+    spinlock_lock(&q->lock);
+    lnk = q->queue.next;
+    while (lnk != &q->queue && n < count) {
+        next = lnk->next;
+        t = list_container(lnk, struct task, condw);
+        if (t->futex.space == space && t->futex.addr == (uintptr_t)uaddr) {
+            t->futex.addr = 0;
+            list_delete(&t->condw);
+            t->state = TASK_RUNNING;
+            n++;
+        }
+        lnk = next;
+    }
+    spinlock_unlock(&q->lock);
+    return n;
+}
+
+void futex_init(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < (1 << FUTEX_HTABLE_BITS); i++)
+        cond_init(&futex_table[i]);
+}
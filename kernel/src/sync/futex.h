@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#ifndef BEEOS_SYNC_FUTEX_H_
+#define BEEOS_SYNC_FUTEX_H_
+
+#include <stdint.h>
+
+/** Futex identifier. */
+struct futex_key {
+    uint32_t    space;  /**< Address space (page directory) */
+    uintptr_t   addr;   /**< User virtual address (0 if not waiting) */
+};
+
+/**
+ * Sleep while the futex word holds the expected value.
+ *
+ * @param uaddr Futex word user address.
+ * @param val   Expected value.
+ * @return      0 if woken up, -EAGAIN if the value did not match or
+ *              -EINTR if interrupted by a signal.
+ */
+int futex_wait(int *uaddr, int val);
+
+/**
+ * Wake up the tasks waiting on a futex word.
+ *
+ * @param uaddr Futex word user address.
+ * @param count Maximum number of tasks to wake up.
+ * @return      Number of woken up tasks.
+ */
+int futex_wake(const int *uaddr, int count);
+
+/**
+ * Initialize the futex wait queues table.
+ */
+void futex_init(void);
+
+#endif /* BEEOS_SYNC_FUTEX_H_ */
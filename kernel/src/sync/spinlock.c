@@ -18,14 +18,18 @@
  */
 
 #include "spinlock.h"
+#include "proc.h"
+#include "arch/x86/misc.h"
 
 void spinlock_init(struct spinlock *lock)
 {
     lock->value = 0;
 }
 
+/* The holder can't be preempted (see preempt_point) */
 void spinlock_lock(struct spinlock *lock)
 {
+    preempt_disable();
     while (__sync_lock_test_and_set(&lock->value, 1) != 0)
         ;
 }
@@ -33,4 +37,20 @@ void spinlock_lock(struct spinlock *lock)
 void spinlock_unlock(struct spinlock *lock)
 {
     __sync_lock_release(&lock->value);
+    preempt_enable();
+}
+
+unsigned long spinlock_lock_irqsave(struct spinlock *lock)
+{
+    unsigned long flags;
+
+    irq_save(flags);
+    spinlock_lock(lock);
+    return flags;
+}
+
+void spinlock_unlock_irqrestore(struct spinlock *lock, unsigned long flags)
+{
+    spinlock_unlock(lock);
+    irq_restore(flags);
 }
@@ -30,5 +30,22 @@ void spinlock_lock(struct spinlock *lock);
 
 void spinlock_unlock(struct spinlock *lock);
 
+/**
+ * Disable interrupts and acquire the lock.
+ * To be used for locks shared with interrupt handlers.
+ *
+ * @param lock  Spinlock.
+ * @return      Previous interrupts state, for spinlock_unlock_irqrestore.
+ */
+unsigned long spinlock_lock_irqsave(struct spinlock *lock);
+
+/**
+ * Release the lock and restore the previous interrupts state.
+ *
+ * @param lock  Spinlock.
+ * @param flags Value returned by spinlock_lock_irqsave.
+ */
+void spinlock_unlock_irqrestore(struct spinlock *lock, unsigned long flags);
+
 
 #endif /* BEEOS_SYNC_SPINLOCK_H_ */
@@ -1 +1 @@
-local_sources := cond.c spinlock.c
+local_sources := cond.c spinlock.c futex.c
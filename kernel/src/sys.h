@@ -24,12 +24,17 @@
 #include <sys/stat.h>
 #include <time.h>
 #include <signal.h>
+#include <dirent.h>
 
 
 void sys_exit(int status);
 
 pid_t sys_fork(void);
 
+pid_t sys_vfork(void);
+
+pid_t sys_clone(unsigned int flags, void *stack);
+
 ssize_t sys_read(int fd, void *buf, size_t count);
 
 ssize_t sys_write(int fd, const void *buf, size_t count);
@@ -103,6 +108,47 @@ unsigned int sys_clock(void);
 
 int sys_info(void);
 
+int sys_futex(int *uaddr, int op, int val);
+
+int sys_sigqueue(pid_t pid, int sig, void *value);
+
+int sys_sigtimedwait(const sigset_t *set, siginfo_t *info,
+                     const struct timespec *timeout);
+
+int sys_eventfd(unsigned int initval, int flags);
+
+int sys_signalfd(int fd, const sigset_t *mask, int flags);
+
+struct rusage;
+
+int sys_getrusage(int who, struct rusage *ru);
+
+struct tms;
+
+unsigned int sys_times(struct tms *buf);
+
+pid_t sys_wait4(pid_t pid, int *wstatus, int options, struct rusage *ru);
+
+struct procinfo;
+
+int sys_procinfo(struct procinfo *buf, int count);
+
+int sys_unlink(const char *pathname);
+
+int sys_mkdir(const char *pathname, mode_t mode);
+
+int sys_rmdir(const char *pathname);
+
+int sys_rename(const char *oldpath, const char *newpath);
+
+void sys_sync(void);
+
+int sys_fsync(int fd);
+
+int sys_ftruncate(int fd, off_t length);
+
+int sys_getdents(int fd, struct dirent *dirp, unsigned int count);
+
 
 void syscall_init(void);
 
@@ -35,5 +35,23 @@ local_sources := syscall.c \
 				 sys_chdir.c \
 				 sys_alarm.c \
 				 sys_mount.c \
-				 sys_clock.c
+				 sys_clock.c \
+				 sys_vfork.c \
+				 sys_clone.c \
+				 sys_futex.c \
+				 sys_sigqueue.c \
+				 sys_sigtimedwait.c \
+				 sys_eventfd.c \
+				 sys_signalfd.c \
+				 sys_getrusage.c \
+				 sys_times.c \
+				 sys_procinfo.c \
+				 sys_unlink.c \
+				 sys_mkdir.c \
+				 sys_rmdir.c \
+				 sys_rename.c \
+				 sys_sync.c \
+				 sys_fsync.c \
+				 sys_ftruncate.c \
+				 sys_getdents.c
 
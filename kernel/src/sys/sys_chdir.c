@@ -33,8 +33,10 @@ int sys_chdir(const char *path)
         return -ENOENT;
     inod = dent->inod;
 
-    if (!S_ISDIR(inod->mode))
+    if (!S_ISDIR(inod->mode)) {
+        dput(dent);
         return -ENOTDIR;
+    }
 
     tmp = current->cwd;
     current->cwd = dent;
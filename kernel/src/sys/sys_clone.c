@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "sys.h"
+#include "proc.h"
+#include "proc/task.h"
+#include <sched.h>
+#include <errno.h>
+
+
+void fork_ret(void);
+
+#define CLONE_FLAGS (CLONE_VM | CLONE_FILES | CLONE_SIGHAND | CLONE_VFORK)
+
+/*
+ * Creates a child process sharing with the caller the resources selected
+ * by flags: address space (CLONE_VM), open files table (CLONE_FILES) and
+ * signal handlers (CLONE_SIGHAND, requires CLONE_VM).
+ * With CLONE_VFORK the caller is suspended until the child calls execve
+ * or exits. If stack is not NULL the child returns to user space with it
+ * as the stack pointer.
+ */
+pid_t sys_clone(unsigned int flags, void *stack)
+{
+    struct task *child;
+
+    if ((flags & ~CLONE_FLAGS) != 0)
+        return -EINVAL;
+    if ((flags & CLONE_SIGHAND) != 0 && (flags & CLONE_VM) == 0)
+        return -EINVAL;
+
+    child = task_create(fork_ret, flags);
+    if (child == NULL)
+        return -ENOMEM;
+
+    /* The child has not run yet */
+    if (stack != NULL)
+        task_arch_ustack(&child->arch, (uintptr_t)stack);
+
+    if ((flags & CLONE_VFORK) != 0) {
+        /* Only the parent reaps the child, thus the pointer stays valid */
+        spinlock_lock(&current->chld_exit.lock);
+        while (child->vfork != 0)
+            cond_wait(&current->chld_exit);
+        spinlock_unlock(&current->chld_exit.lock);
+    }
+
+    return child->pid;
+}
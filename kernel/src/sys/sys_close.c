@@ -30,12 +30,10 @@ int sys_close(int fd)
     struct file *fil;
 
     /* Validate file descriptor */
-    if (fd < 0 || OPEN_MAX <= fd || !current->fds[fd].fil)
+    fil = fd_file(current->files, fd);
+    if (fil == NULL)
         return -EBADF;
-
-    fil = current->fds[fd].fil;
-    current->fds[fd].fil = NULL;
-    current->fds[fd].flags = 0;
+    fd_free(current->files, fd);
 
     fil->ref--;
     if (fil->ref == 0) {
@@ -26,18 +26,15 @@ int sys_dup(int oldfd)
 {
     int newfd;
 
-    if (oldfd < 0 || oldfd >= OPEN_MAX || current->fds[oldfd].fil == NULL)
+    if (fd_file(current->files, oldfd) == NULL)
         return -EBADF; /* Invalid file descriptor */
 
-    for (newfd = 0; newfd < OPEN_MAX; newfd++) {
-        if (current->fds[newfd].fil == NULL) {
-            current->fds[newfd] = current->fds[oldfd];
-            current->fds[newfd].flags &= ~FD_CLOEXEC; /* Posix */
-            current->fds[newfd].fil->ref++;
-            break;
-        }
-    }
-    if (newfd == OPEN_MAX)
-        newfd = -EMFILE; /* Too many open files */
+    newfd = fd_alloc(current->files, 0);
+    if (newfd < 0)
+        return newfd; /* Too many open files */
+
+    current->files->fd[newfd] = current->files->fd[oldfd];
+    current->files->fd[newfd].flags &= ~FD_CLOEXEC; /* Posix */
+    current->files->fd[newfd].fil->ref++;
     return newfd;
 }
@@ -26,22 +26,27 @@ int sys_dup2(int oldfd, int newfd)
 {
     int status;
 
-    if (oldfd < 0 || oldfd >= OPEN_MAX || newfd < 0 || newfd >= OPEN_MAX ||
-            current->fds[oldfd].fil == NULL) {
+    if (newfd < 0 || newfd >= FDTABLE_MAX ||
+            fd_file(current->files, oldfd) == NULL) {
         return -EBADF; /* Invalid file descriptor */
     }
 
     if (oldfd == newfd)
         return oldfd;
 
-    if (current->fds[newfd].fil != NULL) {
+    if (fd_file(current->files, newfd) != NULL) {
         status = sys_close(newfd);
         if (status < 0)
             return status;
     }
 
-    current->fds[newfd] = current->fds[oldfd];
-    current->fds[newfd].flags &= ~FD_CLOEXEC; /* Posix required */
-    current->fds[newfd].fil->ref++;
+    /* The lowest free descriptor not less than newfd is newfd itself */
+    status = fd_alloc(current->files, newfd);
+    if (status < 0)
+        return status;
+
+    current->files->fd[newfd] = current->files->fd[oldfd];
+    current->files->fd[newfd].flags &= ~FD_CLOEXEC; /* Posix required */
+    current->files->fd[newfd].fil->ref++;
     return newfd;
 }
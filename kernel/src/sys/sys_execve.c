@@ -23,12 +23,14 @@
 #include "kmalloc.h"
 #include "kprintf.h"
 #include "proc.h"
+#include "timer.h"
 #include "arch/x86/paging.h"
 #include <sys/types.h>
 #include <stddef.h>
 #include <errno.h>
 #include <limits.h>
 #include <fcntl.h>
+#include <sys/timepage.h>
 
 
 static char *push(char *sp, const char *str)
@@ -105,6 +107,10 @@ static int segment_init(const struct elf_prog_hdr *ph, struct inode *inod)
 
     if (ph->memsz < ph->filesz || KVBASE <= ph->vaddr + ph->memsz)
         return -ENOEXEC;
+    /* The time page is already mapped */
+    if (ph->vaddr < TIMEPAGE_ADDR + PAGE_SIZE &&
+            TIMEPAGE_ADDR < ph->vaddr + ph->memsz)
+        return -ENOEXEC;
 
     /* Look for program brk (temporary... not very elegant) */
     if ((ph->flags & ELF_PROG_FLAG_READ) != 0 &&
@@ -151,6 +157,11 @@ int sys_execve(const char *path, const char *const argv[],
     if (current->arch.ifr == NULL || argv == NULL)
         return -EINVAL;
 
+    /* Tables shared with other threads are not affected by exec */
+    ret = task_unshare(current);
+    if (ret < 0)
+        return ret;
+
     dent = named(path);
     if (dent == NULL)
         return -ENOENT;
@@ -184,6 +195,10 @@ int sys_execve(const char *path, const char *const argv[],
         goto bad;
     memcpy((char *)KVBASE-ARG_MAX, ustack, ARG_MAX);
 
+    /* Read-only time page used by the library clock functions */
+    if ((ret = timepage_map()) < 0)
+        goto bad;
+
     /* Release user stack copy */
     kfree(ustack, ARG_MAX);
 
@@ -211,9 +226,16 @@ int sys_execve(const char *path, const char *const argv[],
     /*** FIXME ARCH specific code ***/
 
     /* Release the old dir just before jump */
-    page_dir_del(current->arch.pgdir);
+    task_arch_pgdir_put(&current->arch);
     current->arch.pgdir = pgdir;
 
+    /* The parent address space is no longer used */
+    task_vfork_done(current);
+
+    /* Command name, the path has gone with the old address space */
+    strncpy(current->comm, dent->name, sizeof(current->comm) - 1);
+    current->comm[sizeof(current->comm) - 1] = '\0';
+
     /* We assume that ARG_MAX is lass than PAGE_SIZE */
     current->arch.ifr->usr_esp = KVBASE-ARG_MAX;
     current->arch.ifr->eip = eh.entry;
@@ -221,9 +243,9 @@ int sys_execve(const char *path, const char *const argv[],
     /*
      * Eventually close files with O_CLOEXEC flag enabled
      */
-    for (i = 0; i < OPEN_MAX; i++) {
-        if (current->fds[i].fil != NULL &&
-           (current->fds[i].flags & O_CLOEXEC) != 0) {
+    for (i = 0; i < current->files->size; i++) {
+        if (current->files->fd[i].fil != NULL &&
+           (current->files->fd[i].flags & O_CLOEXEC) != 0) {
             if (sys_close(i) < 0)
                 kprintf("[warn] error closing an open file\n");
         }
@@ -234,9 +256,9 @@ int sys_execve(const char *path, const char *const argv[],
      * that calls exec is ignoring the signal.
      */
     for (i = 0; i < SIGNALS_NUM; i++) {
-        if (current->signals[i].sa_handler != SIG_IGN) {
-            memset(&current->signals[i], 0, sizeof(struct sigaction));
-            current->signals[i].sa_handler = SIG_DFL;
+        if (current->sighand->action[i].sa_handler != SIG_IGN) {
+            memset(&current->sighand->action[i], 0, sizeof(struct sigaction));
+            current->sighand->action[i].sa_handler = SIG_DFL;
         }
     }
 
@@ -28,85 +28,51 @@ static struct task *find_init(void)
 {
     struct task *t;
 
-    t = list_container(ktask.tasks.next, struct task, tasks);
-    while (t != &ktask) {
-        if (t->pid == 1)
-            break;
-        t = list_container(t->tasks.next, struct task, tasks);
-    }
-    if (t == &ktask)
+    t = task_find(1);
+    if (t == NULL)
         panic("init process not found");
     return t;
 }
 
-static void children_split(struct task *node)
-{
-    struct task *head, *curr;
-    const struct task *prev;
-
-    head = NULL;
-    prev = node;
-    curr = list_container(prev->children.next, struct task, children);
-    while (curr != node) {
-        if (curr->pptr != prev) {
-            head = curr;
-            break;
-        }
-        prev = curr;
-        curr = list_container(curr->children.next, struct task, children);
-    }
-    if (head == NULL)
-        panic("corrupted children hierarchy");
-
-    /* second half */
-    node->children.next->prev = head->children.prev;
-    head->children.prev->next = node->children.next;
-
-    /* first hald */
-    node->children.next = &head->children;
-    head->children.prev = &node->children;
-}
-
-static void children_give(struct task *child)
+/*
+ * Give the children in adoption to init.
+ * Already terminated children are queued on the init zombies list and
+ * init is notified to reap them.
+ */
+static void children_give(void)
 {
     struct task *init_task;
-    struct task *init_child;
-    struct task *curr_task;
+    struct task *child;
+    struct list_link *lnk;
 
     init_task = find_init();
-    init_child = list_container(init_task->children.next,
-                                struct task, children);
-    if (init_child->pid == 0)
-        panic("init has not childs");
-
-    /* node is in the middle of the children chain */
-    children_split(current);
-    curr_task = child;
-    do {
-        if (curr_task->pptr != current)
-            panic("corrupted sibling list");
-        curr_task->pptr = init_task; /* give in adoption */
-        /*
-         * Wake-up to eventually give the oppurtunity to terminate.
-         * This may happen if the process is waiting on a pipe that has
-         * been closed on the other side.
-         */
-        curr_task = list_container(curr_task->sibling.next,
-                                   struct task, sibling);
-    } while (curr_task != child);
-
-    list_merge(&init_child->sibling, &child->sibling);
+    for (lnk = current->children.next; lnk != &current->children;
+         lnk = lnk->next) {
+        child = list_container(lnk, struct task, sibling);
+        child->pptr = init_task;
+    }
+    for (lnk = current->zombies.next; lnk != &current->zombies;
+         lnk = lnk->next) {
+        child = list_container(lnk, struct task, sibling);
+        child->pptr = init_task;
+    }
+    if (!list_empty(&current->children)) {
+        list_merge(&init_task->children, &current->children);
+        list_delete(&current->children);
+    }
+    if (!list_empty(&current->zombies)) {
+        list_merge(&init_task->zombies, &current->zombies);
+        list_delete(&current->zombies);
+        spinlock_lock(&init_task->chld_exit.lock);
+        cond_signal(&init_task->chld_exit);
+        spinlock_unlock(&init_task->chld_exit.lock);
+    }
 }
 
-/*
- * An exited process remains in the zombie state until its parent
- * calls wait() to find out it exited.
- */
 void sys_exit(int status)
 {
     struct list_link *lnk;
     struct timer_event *tm;
-    struct task *child;
     int i;
 
     if (current->pid == 1)
@@ -120,21 +86,24 @@ void sys_exit(int status)
         timer_event_del(tm); /* Remove from the global queue */
     }
 
-    /* close all open files */
-    for (i = 0; i < OPEN_MAX; i++) {
-        if (current->fds[i].fil != NULL) {
-            if (sys_close(i) < 0) {
-                /* Should never happen... */
-                kprintf("[warn] sys_close error on opened file\n");
+    /* close all open files, unless the table is shared */
+    if (current->files->ref == 1) {
+        for (i = 0; i < current->files->size; i++) {
+            if (current->files->fd[i].fil != NULL) {
+                if (sys_close(i) < 0) {
+                    /* Should never happen... */
+                    kprintf("[warn] sys_close error on opened file\n");
+                }
             }
         }
     }
+    task_files_put(current);
+
+    /* Resume the parent if created by vfork */
+    task_vfork_done(current);
 
     /* Give children to init */
-    child = list_container(current->children.next,
-                           struct task, children);
-    if (child->pptr == current)
-        children_give(child); /* Wrap around, current is not a leaf */
+    children_give();
 
     /* Send SIGCHLD to the parent */
     task_signal(current->pptr, SIGCHLD);
@@ -142,7 +111,11 @@ void sys_exit(int status)
     /* Acquire the father conditional variable to prevent lost signals */
     spinlock_lock(&current->pptr->chld_exit.lock);
     current->state = TASK_ZOMBIE;
-    current->exit_code = status;
+    /* Wait status: the exit code is in the second byte */
+    current->exit_code = (status & 0xFF) << 8;
+    /* Move to the parent zombies queue */
+    list_delete(&current->sibling);
+    list_insert_before(&current->pptr->zombies, &current->sibling);
     cond_signal(&current->pptr->chld_exit);
     spinlock_unlock(&current->pptr->chld_exit.lock);
 
@@ -29,7 +29,7 @@ pid_t sys_fork(void)
 {
     const struct task *child;
 
-    child = task_create(fork_ret);
+    child = task_create(fork_ret, 0);
     if (child == NULL)
         return -1;
     return child->pid;
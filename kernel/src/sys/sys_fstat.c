@@ -25,11 +25,13 @@
 int sys_fstat(int fd, struct stat *buf)
 {
     const struct inode *inod;
+    const struct file *fil;
 
-    if (current->fds[fd].fil == NULL)
+    fil = fd_file(current->files, fd);
+    if (fil == NULL)
         return -EBADF;  /* Bad file descriptor */
 
-    inod = current->fds[fd].fil->dent->inod;
+    inod = fil->dent->inod;
     if (inod == NULL)
         return -ENOENT;
 
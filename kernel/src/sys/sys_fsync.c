@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "sys.h"
+#include "fs/vfs.h"
+#include "fs/buf.h"
+#include "fs/pcache.h"
+#include "proc.h"
+#include <errno.h>
+
+/*
+ * The file dirty pages are written back to the buffer cache. Buffers are
+ * not tracked per file, all the dirty buffers of the file system device
+ * are written back.
+ */
+int sys_fsync(int fd)
+{
+    const struct file *fil;
+    struct inode *inod;
+    int res;
+
+    fil = fd_file(current->files, fd);
+    if (fil == NULL)
+        return -EBADF;
+    inod = fil->dent->inod;
+    if (inod->sb == NULL)
+        return -EINVAL; /* Pipes and other special files */
+    res = pcache_writeback(inod, 1);
+    if (res == 0)
+        res = bsync(inod->sb->dev);
+    return res;
+}
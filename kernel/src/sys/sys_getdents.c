@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+#include "sys.h"
+#include "fs/vfs.h"
+#include "proc.h"
+#include <errno.h>
+
+/*
+ * Read as many directory entries as fit in the buffer.
+ * The directory cursor is kept in the file offset.
+ */
+int sys_getdents(int fd, struct dirent *dirp, unsigned int count)
+{
+    int n;
+    struct file *fil;
+
+    fil = fd_file(current->files, fd);
+    if (fil == NULL)
+        return -EBADF;
+    if (!S_ISDIR(fil->dent->inod->mode))
+        return -ENOTDIR;
+    if (count < sizeof(struct dirent))
+        return -EINVAL;
+
+    n = vfs_readdir(fil->dent, &fil->off, dirp,
+                    count / sizeof(struct dirent));
+    if (n > 0) {
+        n *= sizeof(struct dirent);
+        current->acct.rchar += n;
+    }
+    return n;
+}
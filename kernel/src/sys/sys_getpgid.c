@@ -30,17 +30,8 @@
  */
 pid_t sys_getpgid(pid_t pid)
 {
-    const struct task *t = NULL;
-    const struct task *curr = current;
+    const struct task *t;
 
-    if (pid == 0)
-        pid = current->pid;
-    do {
-        if (curr->pid == pid) {
-            t = curr;
-            break;
-        }
-        curr = list_container(curr->tasks.next, struct task, tasks);
-    } while (curr != current);
+    t = (pid == 0) ? current : task_find(pid);
     return (t != NULL) ? t->pgid : -ESRCH;
 }
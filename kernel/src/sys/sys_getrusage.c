@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "sys.h"
+#include "proc.h"
+#include <sys/resource.h>
+#include <errno.h>
+
+int sys_getrusage(int who, struct rusage *ru)
+{
+    if (ru == NULL)
+        return -EFAULT;
+
+    switch (who) {
+    case RUSAGE_SELF:
+        acct_rusage(&current->acct, ru);
+        break;
+    case RUSAGE_CHILDREN:
+        acct_rusage(&current->cacct, ru);
+        break;
+    default:
+        return -EINVAL;
+    }
+    return 0;
+}
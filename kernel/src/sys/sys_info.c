@@ -20,11 +20,15 @@
 #include "sys.h"
 #include "proc.h"
 #include "mm/frame.h"
+#include "fs/buf.h"
+#include "fs/pcache.h"
 
 
 int sys_info(void)
 {
     frame_dump();
     proc_dump();
+    buf_dump();
+    pcache_dump();
     return 0;
 }
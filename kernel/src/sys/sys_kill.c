@@ -21,6 +21,7 @@
 #include "proc.h"
 #include "kprintf.h"
 #include <errno.h>
+#include <string.h>
 
 /*
  * POSIX.1  requires  that  if  a process sends a signal to itself,
@@ -33,25 +34,56 @@
  * global isr procedure before returning to user-space.
  */
 
+/*
+ * If pid is positive the signal is sent to the process with that ID.
+ * If pid is zero the signal is sent to every process in the process group
+ * of the caller, if pid is less than -1 the signal is sent to every process
+ * in the process group whose ID is -pid.
+ * If pid is -1 the signal is sent to every process except the kernel task,
+ * init and the caller.
+ */
 int sys_kill(pid_t pid, int sig)
 {
     struct task *t;
+    int found;
+    siginfo_t info;
 
-    if (sig <= 0 || sig > SIGUNUSED)
+    if (sig < 0 || sig >= NSIG)
         return -EINVAL;
 
-    t = current;
-    do {
-        if (t->pid == pid) {
-            /* TODO: check for permissions */
+    memset(&info, 0, sizeof(info));
+    info.si_signo = sig;
+    info.si_code = SI_USER;
+    info.si_pid = current->pid;
+    info.si_uid = current->uid;
+
+    /* TODO: check for permissions */
 
-            /* if sig is 0, only permissions are checked */
+    if (pid > 0) {
+        t = task_find(pid);
+        if (t == NULL)
+            return -ESRCH;
+        /* if sig is 0, only permissions are checked */
+        if (sig != 0)
+            (void)task_sigqueue(t, &info);
+        return 0;
+    }
+
+    if (pid == 0)
+        return pgrp_signal(current->pgid, &info);
+    if (pid < -1)
+        return pgrp_signal(-pid, &info);
+
+    /* Broadcast, walk the whole tasks list */
+    found = 0;
+    t = list_container(ktask.tasks.next, struct task, tasks);
+    while (t != &ktask) {
+        if (t->pid != 1 && t != current) {
+            found = 1;
             if (sig != 0)
-                task_signal(t, sig);
-            break;
+                (void)task_sigqueue(t, &info);
         }
-        t = struct_ptr(t->tasks.next, struct task, tasks);
-    } while (t != current);
-
-    return 0;
+        t = list_container(t->tasks.next, struct task, tasks);
+    }
+    return (found != 0) ? 0 : -ESRCH;
 }
@@ -28,10 +28,9 @@ off_t sys_lseek(int fd, off_t offset, int whence)
     struct file *fil;
     off_t newoffset;
 
-    if (fd < 0 || OPEN_MAX <= fd || !current->fds[fd].fil)
+    fil = fd_file(current->files, fd);
+    if (fil == NULL)
         return -EBADF;
-
-    fil = current->fds[fd].fil;
     switch (whence) {
     case SEEK_SET:
         newoffset = offset;
@@ -25,39 +25,10 @@
 #include <string.h>
 
 
-static void split_path(const char *filepath, char *parent, char *name)
-{
-    int i, k;
-
-    i = strlen(filepath);
-    while (i > 0) {
-        i--;
-        if (filepath[i] == '/')
-            break;
-    }
-    if (i > 0) {
-        k = (*filepath == '/') ? 1 : 0;
-        strncpy(parent, filepath, i);
-        strcpy(name, filepath + i + k);
-    } else {
-        parent[i++] = '/';
-        if (filepath[i] != '\0') {
-            strcpy(name, filepath + i);
-        } else {
-            name[0] = '.';
-            name[1] = '\0';
-        }
-    }
-    parent[i] = '\0';
-}
-
-
 int sys_mknod(const char *pathname, mode_t mode, dev_t dev)
 {
     int res;
     struct dentry *dent;
-    const struct dentry *dnew;
-    char parent[PATH_MAX];
     char name[NAME_MAX];
 
     dent = named(pathname);
@@ -66,22 +37,17 @@ int sys_mknod(const char *pathname, mode_t mode, dev_t dev)
         return -EEXIST;
     }
 
-    split_path(pathname, parent, name);
-
-    dent = named(parent);
+    dent = named_parent(pathname, name);
     if (dent == NULL)
-        return -1;
-
-    res = vfs_mknod(dent->inod, mode, dev);
-
-    /*
-     * Create a dentry and keep a reference to it.
-     */
-    if (res == 0) {
-        dnew = dget(dent, name);
-        if (dnew == NULL)
-            res = -1;
+        return -ENOENT;
+    if (name_is_dots(name)) {
+        dput(dent);
+        return -EEXIST;
     }
+
+    res = vfs_mknod(dent->inod, name, mode, dev);
+    if (res == 0)
+        dentry_forget(dent, name);
     dput(dent);
     return res;
 }
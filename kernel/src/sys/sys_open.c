@@ -26,9 +26,37 @@
 #include <fcntl.h>
 
 
+/*
+ * Create a regular file and return its dentry.
+ */
+static int file_create(const char *pathname, mode_t mode,
+                       struct dentry **dentp)
+{
+    int res;
+    struct dentry *dir;
+    char name[NAME_MAX];
+
+    dir = named_parent(pathname, name);
+    if (dir == NULL)
+        return -ENOENT;
+    if (name_is_dots(name)) {
+        res = -EISDIR;
+    } else {
+        res = vfs_mknod(dir->inod, name, S_IFREG | (mode & 07777), 0);
+        if (res == 0) {
+            dentry_forget(dir, name);
+            *dentp = dget(dir, name);
+            if (*dentp == NULL)
+                res = -ENOENT;
+        }
+    }
+    dput(dir);
+    return res;
+}
+
 int sys_open(const char *pathname, int flags, mode_t mode)
 {
-    int fdn;
+    int fdn, res;
     struct file *fil;
     struct dentry *dent;
 
@@ -36,8 +64,23 @@ int sys_open(const char *pathname, int flags, mode_t mode)
         return -EINVAL;
 
     dent = named(pathname);
-    if (dent == NULL)
-        return -ENOENT;
+    if (dent == NULL) {
+        if ((flags & O_CREAT) == 0)
+            return -ENOENT;
+        res = file_create(pathname, mode, &dent);
+        if (res < 0)
+            return res;
+    } else if ((flags & (O_CREAT | O_EXCL)) == (O_CREAT | O_EXCL)) {
+        dput(dent);
+        return -EEXIST;
+    } else if ((flags & O_TRUNC) != 0 && S_ISREG(dent->inod->mode) &&
+               (flags & O_ACCMODE) != O_RDONLY) {
+        res = vfs_truncate(dent->inod, 0);
+        if (res < 0) {
+            dput(dent);
+            return res;
+        }
+    }
 
     if (current->pid == current->pgid &&
         (flags & O_NOCTTY) == 0 &&
@@ -47,16 +90,15 @@ int sys_open(const char *pathname, int flags, mode_t mode)
             return -EBUSY;
     }
 
-    for (fdn = 0; fdn < OPEN_MAX; fdn++) {
-        if (current->fds[fdn].fil == NULL)
-            break;
-    }
-    if (fdn == OPEN_MAX)
-        return -EMFILE; /* Too many open files. */
+    fdn = fd_alloc(current->files, 0);
+    if (fdn < 0)
+        return fdn; /* Too many open files. */
 
     fil = fs_file_alloc();
-    if (fil == NULL)
+    if (fil == NULL) {
+        fd_free(current->files, fdn);
         return -ENOMEM;
+    }
 
     fil->ref = 1;
     fil->off = 0;
@@ -64,8 +106,8 @@ int sys_open(const char *pathname, int flags, mode_t mode)
     fil->flags = (unsigned int)flags & ~O_CLOEXEC;
     fil->dent = dent;
 
-    current->fds[fdn].fil = fil;
-    current->fds[fdn].flags = (unsigned int)flags & O_CLOEXEC;
+    current->files->fd[fdn].fil = fil;
+    current->files->fd[fdn].flags = (unsigned int)flags & O_CLOEXEC;
 
     return fdn;
 }
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "sys.h"
+#include "proc.h"
+#include <sys/procinfo.h>
+#include <string.h>
+#include <errno.h>
+
+
+static void procinfo_fill(struct procinfo *pi, const struct task *t)
+{
+    pi->pid = t->pid;
+    pi->ppid = t->pptr->pid;
+    pi->pgid = t->pgid;
+    pi->uid = t->uid;
+    pi->state = (t->state == TASK_RUNNING) ? 'R' :
+                (t->state == TASK_ZOMBIE) ? 'Z' : 'S';
+    memcpy(pi->comm, t->comm, sizeof(pi->comm));
+    pi->utime = t->acct.utime;
+    pi->stime = t->acct.stime;
+    pi->minflt = t->acct.minflt;
+    pi->nvcsw = t->acct.nvcsw;
+    pi->nivcsw = t->acct.nivcsw;
+    pi->nsyscalls = t->acct.nsyscalls;
+    pi->rchar = t->acct.rchar;
+    pi->wchar = t->acct.wchar;
+}
+
+/*
+ * Snapshot of the processes in the global tasks list, the kernel task
+ * included.
+ */
+int sys_procinfo(struct procinfo *buf, int count)
+{
+    int n = 0;
+    const struct task *t = &ktask;
+
+    if (count < 0 || (buf == NULL && count > 0))
+        return -EINVAL;
+
+    do {
+        if (n < count)
+            procinfo_fill(&buf[n], t);
+        n++;
+        t = list_container_const(t->tasks.next, struct task, tasks);
+    } while (t != &ktask);
+    return n;
+}
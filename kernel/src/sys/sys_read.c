@@ -31,11 +31,10 @@ ssize_t sys_read(int fd, void *buf, size_t count)
     ssize_t n;
     struct file *fil;
 
-    if (fd < 0 || fd >= OPEN_MAX || current->fds[fd].fil == NULL)
+    fil = fd_file(current->files, fd);
+    if (fil == NULL)
         return -EBADF;
 
-    fil = current->fds[fd].fil;
-
     switch (fil->dent->inod->mode & S_IFMT) {
     case S_IFBLK:
     case S_IFCHR:
@@ -45,17 +44,16 @@ ssize_t sys_read(int fd, void *buf, size_t count)
         n = vfs_read(fil->dent->inod, buf, count, fil->off);
         break;
     case S_IFDIR:
-        n = fil->off/sizeof(struct dirent);
-        n = vfs_readdir(fil->dent, n, (struct dirent *)buf);
-        if (n == 0)
-            n = sizeof(struct dirent);
-        break;
+        /* The offset is the directory cursor, not a byte count */
+        return sys_getdents(fd, (struct dirent *)buf, count);
     default:
         n = -1;
         break;
     }
 
-    if (n > 0)
+    if (n > 0) {
         fil->off += n;
+        current->acct.rchar += n;
+    }
     return n;
 }
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "sys.h"
+#include "fs/vfs.h"
+#include <errno.h>
+#include <limits.h>
+
+/*
+ * Check if a directory is an ancestor of (or the same as) another one.
+ * Both the dentries are expected to be within the same filesystem.
+ */
+static int is_ancestor(const struct dentry *dir, const struct dentry *dent)
+{
+    while (dent != dir && dent != dent->parent)
+        dent = dent->parent;
+    return dent == dir;
+}
+
+static int rename_dentry(struct dentry *odir, const char *oname,
+                         struct dentry *ndir, const char *nname)
+{
+    int res;
+    struct dentry *dent, *target;
+
+    dent = dget(odir, oname);
+    if (dent == NULL)
+        return -ENOENT;
+
+    target = dget(ndir, nname);
+    if (dent->mounted != 0 || (target != NULL && target->mounted != 0))
+        res = -EBUSY;
+    else if (S_ISDIR(dent->inod->mode) && is_ancestor(dent, ndir))
+        res = -EINVAL;
+    else if (target != NULL && target->inod == dent->inod)
+        res = 1; /* Same file, nothing to do */
+    else
+        res = vfs_rename(odir->inod, oname, ndir->inod, nname);
+
+    if (res == 0) {
+        if (target != NULL)
+            dentry_drop(target);
+        dentry_move(dent, ndir, nname);
+    }
+    if (target != NULL)
+        dput(target);
+    dput(dent);
+    return (res > 0) ? 0 : res;
+}
+
+int sys_rename(const char *oldpath, const char *newpath)
+{
+    int res;
+    struct dentry *odir, *ndir;
+    char oname[NAME_MAX];
+    char nname[NAME_MAX];
+
+    odir = named_parent(oldpath, oname);
+    if (odir == NULL)
+        return -ENOENT;
+    ndir = named_parent(newpath, nname);
+    if (ndir == NULL) {
+        dput(odir);
+        return -ENOENT;
+    }
+
+    if (name_is_dots(oname) || name_is_dots(nname))
+        res = -EINVAL;
+    else if (odir->inod->sb != ndir->inod->sb)
+        res = -EXDEV;
+    else
+        res = rename_dentry(odir, oname, ndir, nname);
+
+    dput(ndir);
+    dput(odir);
+    return res;
+}
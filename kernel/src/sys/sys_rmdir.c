@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "sys.h"
+#include "fs/vfs.h"
+#include <errno.h>
+#include <limits.h>
+
+int sys_rmdir(const char *pathname)
+{
+    int res;
+    struct dentry *dir, *dent;
+    char name[NAME_MAX];
+
+    dir = named_parent(pathname, name);
+    if (dir == NULL)
+        return -ENOENT;
+
+    dent = name_is_dots(name) ? NULL : dget(dir, name);
+    if (dent != NULL) {
+        if (!S_ISDIR(dent->inod->mode))
+            res = -ENOTDIR;
+        else if (dent->mounted != 0)
+            res = -EBUSY;
+        else
+            res = vfs_rmdir(dir->inod, name);
+        if (res == 0)
+            dentry_drop(dent);
+        dput(dent);
+    } else {
+        res = name_is_dots(name) ? -EINVAL : -ENOENT;
+    }
+    dput(dir);
+    return res;
+}
@@ -37,7 +37,7 @@
  */
 int sys_setpgid(pid_t pid, pid_t pgid)
 {
-    struct task *t = NULL;
+    struct task *t;
 
     if (pgid < 0)
         return -EINVAL;
@@ -47,26 +47,14 @@ int sys_setpgid(pid_t pid, pid_t pgid)
         pgid = pid;
 
     if (pid != current->pid) {
-        struct task *child, *sib;
-
-        child = list_container(current->children.next, struct task,
-                               children);
-        if (child->pptr != current)
-            return -ESRCH; /* Wrap around... */
-
-        sib = child;
-        do {
-            if (sib->pid == pid) {
-                t = sib;
-                break;
-            }
-            sib = list_container(sib->sibling.next, struct task, sibling);
-        } while (sib != child);
-        if (t == NULL)
+        t = task_find(pid);
+        if (t == NULL || t->pptr != current)
             return -ESRCH;
     } else {
         t = current;
     }
-    t->pgid = pgid;
-    return 0;
+    /* Only an existing group can be joined, or a new one with own pid */
+    if (pgid != pid && pgrp_find(pgid) == NULL)
+        return -EPERM;
+    return pgrp_join(t, pgid);
 }
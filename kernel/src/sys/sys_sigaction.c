@@ -24,7 +24,7 @@
 int sys_sigaction(int sig, const struct sigaction *act,
         struct sigaction *oact)
 {
-    if (sig <= 0 || sig > SIGNALS_NUM)
+    if (sig <= 0 || sig >= SIGNALS_NUM)
         return -EINVAL;
 
     /* POSIX.1: SIGSTOP and SIGKILL can't be caught nor ignored */
@@ -32,8 +32,8 @@ int sys_sigaction(int sig, const struct sigaction *act,
         return 0;
 
     if (oact != NULL)
-        *oact = current->signals[sig-1];
-    current->signals[sig-1] = *act;
+        *oact = current->sighand->action[sig-1];
+    current->sighand->action[sig-1] = *act;
 
     return 0;
 }
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "sys.h"
+#include "proc.h"
+#include <errno.h>
+#include <string.h>
+
+int sys_sigqueue(pid_t pid, int sig, void *value)
+{
+    struct task *t;
+    siginfo_t info;
+
+    if (sig < 0 || sig >= NSIG)
+        return -EINVAL;
+
+    t = task_find(pid);
+    if (t == NULL)
+        return -ESRCH;
+    /* if sig is 0, only the existence is checked */
+    if (sig == 0)
+        return 0;
+
+    memset(&info, 0, sizeof(info));
+    info.si_signo = sig;
+    info.si_code = SI_QUEUE;
+    info.si_pid = current->pid;
+    info.si_uid = current->uid;
+    info.si_value.sival_ptr = value;
+    return task_sigqueue(t, &info);
+}
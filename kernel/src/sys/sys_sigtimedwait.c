@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "sys.h"
+#include "proc.h"
+#include "timer.h"
+#include <errno.h>
+
+/* Signals that can't be waited for */
+#define SIGWAIT_DENY    (((sigset_t)1 << SIGKILL) | ((sigset_t)1 << SIGSTOP))
+
+
+static void sigwait_timer_handler(void *data)
+{
+    struct task *t = (struct task *)data;
+
+    t->state = TASK_RUNNING;
+}
+
+int sys_sigtimedwait(const sigset_t *set, siginfo_t *info,
+                     const struct timespec *timeout)
+{
+    int sig;
+    sigset_t wait;
+    siginfo_t si;
+    unsigned long ms, when = 0;
+    struct timer_event tm;
+
+    if (set == NULL)
+        return -EFAULT;
+    wait = *set & ~SIGWAIT_DENY;
+
+    if (timeout != NULL) {
+        if ((long)timeout->tv_sec < 0 || timeout->tv_nsec < 0 ||
+            timeout->tv_nsec > 999999999)
+            return -EINVAL;
+        ms   = (unsigned long)timeout->tv_sec * 1000 +
+               (unsigned long)timeout->tv_nsec / 1000000;
+        when = timer_ticks + msecs_to_ticks(ms);
+    }
+
+    while ((sig = sig_dequeue(current, wait, &si)) == 0) {
+        /* Not waited signals are handled on the way back to user space */
+        if ((current->sigpend & ~current->sigmask) != 0)
+            return -EINTR;
+        if (timeout != NULL && timer_ticks >= when)
+            return -EAGAIN;
+
+        current->sigwait = wait;
+        current->state = TASK_SLEEPING;
+        if (timeout != NULL) {
+            timer_event_init(&tm, sigwait_timer_handler, current, when);
+            list_insert_before(&current->timers, &tm.plink);
+            timer_event_add(&tm);
+        }
+
+        scheduler();
+
+        if (timeout != NULL) {
+            list_delete(&tm.link);  /* in case of an early wakeup */
+            list_delete(&tm.plink);
+        }
+        sigemptyset(&current->sigwait);
+    }
+
+    if (info != NULL)
+        *info = si;
+    return sig;
+}
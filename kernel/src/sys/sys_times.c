@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "sys.h"
+#include "proc.h"
+#include "timer.h"
+#include <sys/times.h>
+
+unsigned int sys_times(struct tms *buf)
+{
+    if (buf != NULL) {
+        buf->tms_utime = current->acct.utime;
+        buf->tms_stime = current->acct.stime;
+        buf->tms_cutime = current->cacct.utime;
+        buf->tms_cstime = current->cacct.stime;
+    }
+    return (unsigned int)timer_ticks;
+}
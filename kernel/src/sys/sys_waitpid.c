@@ -22,13 +22,77 @@
 #include "util.h"
 #include <sys/wait.h>
 
+/*
+ * Check if a child matches the waitpid pid argument.
+ * Zero and values less than -1 select a process group.
+ */
+static int child_match(const struct task *t, pid_t pid)
+{
+    if (pid == -1)
+        return 1;
+    if (pid > 0)
+        return t->pid == pid;
+    return t->pgid == ((pid == 0) ? current->pgid : -pid);
+}
+
+/*
+ * Look for a terminated child matching pid.
+ * Terminated children are queued by sys_exit on the parent zombies list,
+ * a specific pid is resolved with the pid hash table.
+ */
+static struct task *zombie_find(pid_t pid, int *havekids)
+{
+    struct task *t;
+    struct list_link *lnk;
+
+    if (pid > 0) {
+        t = task_find(pid);
+        if (t == NULL || t->pptr != current) {
+            *havekids = 0;
+            return NULL;
+        }
+        *havekids = 1;
+        return (t->state == TASK_ZOMBIE) ? t : NULL;
+    }
+
+    if (pid == -1) {
+        *havekids = !list_empty(&current->children) ||
+                    !list_empty(&current->zombies);
+        if (list_empty(&current->zombies))
+            return NULL;
+        return list_container(current->zombies.next, struct task, sibling);
+    }
+
+    *havekids = 0;
+    for (lnk = current->zombies.next; lnk != &current->zombies;
+         lnk = lnk->next) {
+        t = list_container(lnk, struct task, sibling);
+        if (child_match(t, pid)) {
+            *havekids = 1;
+            return t;
+        }
+    }
+    for (lnk = current->children.next; lnk != &current->children;
+         lnk = lnk->next) {
+        t = list_container(lnk, struct task, sibling);
+        if (child_match(t, pid)) {
+            *havekids = 1;
+            break;
+        }
+    }
+    return NULL;
+}
+
 /*
  * Wait for a child process to exit and return its pid.
  * Return -1 if this process has no children.
+ * The child resources usage, with the one of its waited for children, is
+ * charged to the caller children usage.
  */
-pid_t sys_waitpid(pid_t pid, int *wstatus, int options)
+pid_t sys_wait4(pid_t pid, int *wstatus, int options, struct rusage *ru)
 {
     struct task *t;
+    struct task_acct acct;
     int havekids;
     int retry;
 
@@ -36,42 +100,33 @@ pid_t sys_waitpid(pid_t pid, int *wstatus, int options)
 
     do {
         retry = 0;
-        havekids = 0;
-
-        t = struct_ptr(current->tasks.next, struct task, tasks);
-        while (t != current) {
-            if (t->pptr == current && (pid == t->pid || pid == -1)) {
-                havekids = 1;
-                if (t->state == TASK_ZOMBIE) {
-                    /* found one */
-                    pid = t->pid;
-                    if (wstatus != NULL)
-                        *wstatus = t->exit_code;
-                    /* resources already released by the sys_exit */
-                    list_delete(&t->tasks);
-                    list_delete(&t->children);
-                    list_delete(&t->sibling);
-                    task_delete(t);
-                    break;
-                }
-            }
-            t = struct_ptr(t->tasks.next, struct task, tasks);
-        }
 
-        if (t == current) {
-            /* We've not found any terminated children */
-            if (havekids != 0) {
-                /* There are not terminated children around */
-                if ((options & WNOHANG) == 0) {
-                    /* WNOHANG flag not specified, wait for a child */
-                    cond_wait(&current->chld_exit);
-                    retry = 1;
-                } else {
-                    pid = 0;
-                }
+        t = zombie_find(pid, &havekids);
+        if (t != NULL) {
+            /* found one */
+            pid = t->pid;
+            if (wstatus != NULL)
+                *wstatus = t->exit_code;
+            acct = t->acct;
+            acct_add(&acct, &t->cacct);
+            acct_add(&current->cacct, &acct);
+            if (ru != NULL)
+                acct_rusage(&acct, ru);
+            /* resources already released by the sys_exit */
+            list_delete(&t->tasks);
+            list_delete(&t->sibling);
+            task_delete(t);
+        } else if (havekids != 0) {
+            /* There are not terminated children around */
+            if ((options & WNOHANG) == 0) {
+                /* WNOHANG flag not specified, wait for a child */
+                cond_wait(&current->chld_exit);
+                retry = 1;
             } else {
-                pid = -1;
+                pid = 0;
             }
+        } else {
+            pid = -1;
         }
     } while (retry != 0);
 
@@ -79,3 +134,8 @@ pid_t sys_waitpid(pid_t pid, int *wstatus, int options)
 
     return pid;
 }
+
+pid_t sys_waitpid(pid_t pid, int *wstatus, int options)
+{
+    return sys_wait4(pid, wstatus, options, NULL);
+}
@@ -32,15 +32,22 @@ ssize_t sys_write(int fd, const void *buf, size_t count)
     ssize_t n;
     struct file *fil;
 
-    if (fd < 0 || fd >= OPEN_MAX || current->fds[fd].fil == NULL)
+    fil = fd_file(current->files, fd);
+    if (fil == NULL)
         return -EBADF;
 
-    fil = current->fds[fd].fil;
-
     switch (fil->dent->inod->mode & S_IFMT) {
+    case S_IFREG:
+        if ((fil->flags & O_ACCMODE) == O_RDONLY) {
+            n = -EBADF;
+            break;
+        }
+        if ((fil->flags & O_APPEND) != 0)
+            fil->off = fil->dent->inod->size;
+        n = vfs_write(fil->dent->inod, buf, count, fil->off);
+        break;
     case S_IFBLK:
     case S_IFCHR:
-    case S_IFREG:
     case S_IFIFO:
     case S_IFSOCK:
         n = vfs_write(fil->dent->inod, buf, count, fil->off);
@@ -53,7 +60,9 @@ ssize_t sys_write(int fd, const void *buf, size_t count)
         break;
     }
 
-    if (n > 0)
+    if (n > 0) {
         fil->off += n;
+        current->acct.wchar += n;
+    }
     return n;
 }
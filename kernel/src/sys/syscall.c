@@ -24,7 +24,7 @@
 #include <unistd.h>
 
 
-#define SYSCALLS_NUM    (__NR_info + 1)
+#define SYSCALLS_NUM    (__NR_getdents + 1)
 
 static const void *syscalls[SYSCALLS_NUM] = {
     [__NR_exit]         = sys_exit,
@@ -64,6 +64,25 @@ static const void *syscalls[SYSCALLS_NUM] = {
     [__NR_setgid]       = sys_setgid,
     [__NR_clock]        = sys_clock,
     [__NR_info]         = sys_info,
+    [__NR_vfork]        = sys_vfork,
+    [__NR_clone]        = sys_clone,
+    [__NR_futex]        = sys_futex,
+    [__NR_sigqueue]     = sys_sigqueue,
+    [__NR_sigtimedwait] = sys_sigtimedwait,
+    [__NR_eventfd]      = sys_eventfd,
+    [__NR_signalfd]     = sys_signalfd,
+    [__NR_getrusage]    = sys_getrusage,
+    [__NR_times]        = sys_times,
+    [__NR_wait4]        = sys_wait4,
+    [__NR_procinfo]     = sys_procinfo,
+    [__NR_unlink]       = sys_unlink,
+    [__NR_mkdir]        = sys_mkdir,
+    [__NR_rmdir]        = sys_rmdir,
+    [__NR_rename]       = sys_rename,
+    [__NR_sync]         = sys_sync,
+    [__NR_fsync]        = sys_fsync,
+    [__NR_ftruncate]    = sys_ftruncate,
+    [__NR_getdents]     = sys_getdents,
 };
 
 
@@ -91,6 +91,22 @@ void timer_event_mod(struct timer_event *tm, unsigned long expires);
  */
 void timer_init(void);
 
+/**
+ * Maps the read-only time page in the current process user space.
+ * The page layout is described in <sys/timepage.h>.
+ *
+ * @return  0 on success, a negative error code otherwise.
+ */
+int timepage_map(void);
+
+/**
+ * Publishes the CPU time of the task that is going to run in the
+ * time page.
+ *
+ * @param usage     Task CPU time in clock ticks.
+ */
+void timepage_switch(clock_t usage);
+
 /**
  * Timer wheel update.
  *
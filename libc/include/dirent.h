@@ -29,9 +29,14 @@ struct dirent {
     char    d_name[NAME_MAX+1];     /** Directory name */
 };
 
+/** Directory entries fetched by a single readdir system call. */
+#define DIR_BUF_ENTRIES     32
+
 typedef struct DIR {
     int    fdn;          /** Directory file descriptor */
-    struct dirent dent;  /** Last directory entry */
+    int    pos;          /** Next buffered entry */
+    int    count;        /** Number of buffered entries */
+    struct dirent dents[DIR_BUF_ENTRIES];  /** Entries buffer */
 } DIR;
 
 DIR *opendir(const char *name);
@@ -42,4 +47,7 @@ struct dirent *readdir(DIR *dirp);
 
 void rewinddir(DIR *dirp);
 
+/** Read as many directory entries as fit in count bytes. */
+int getdents(int fd, struct dirent *dirp, unsigned int count);
+
 #endif /* _DIRENT_H_ */
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Minimal POSIX threads.
+ *
+ * Threads are processes created with clone() sharing the address space,
+ * the open files and the signal handlers. A thread can be joined only by
+ * the thread that created it. The library functions are not thread-safe,
+ * concurrent calls (e.g. to malloc) shall be serialized by the caller.
+ */
+
+#ifndef _PTHREAD_H_
+#define _PTHREAD_H_
+
+#include <sys/types.h>
+
+/** Thread stack size. */
+#define PTHREAD_STACK_SIZE  (16 * 1024)
+
+/** Thread handle. */
+typedef struct pthread *pthread_t;
+
+/** Thread attributes (unused). */
+typedef struct {
+    int unused;
+} pthread_attr_t;
+
+/** Mutex. */
+typedef struct {
+    int lock;   /** 0: unlocked, 1: locked, 2: locked with waiters */
+} pthread_mutex_t;
+
+/** Mutex attributes (unused). */
+typedef struct {
+    int unused;
+} pthread_mutexattr_t;
+
+/** Condition variable. */
+typedef struct {
+    int seq;        /** Sequence number, bumped on every signal */
+    int waiters;    /** Number of waiting threads */
+} pthread_cond_t;
+
+/** Condition variable attributes (unused). */
+typedef struct {
+    int unused;
+} pthread_condattr_t;
+
+#define PTHREAD_MUTEX_INITIALIZER   { 0 }
+
+#define PTHREAD_COND_INITIALIZER    { 0, 0 }
+
+
+int pthread_create(pthread_t *thread, const pthread_attr_t *attr,
+                   void *(*start)(void *), void *arg);
+
+int pthread_join(pthread_t thread, void **retval);
+
+int pthread_mutex_init(pthread_mutex_t *mutex,
+                       const pthread_mutexattr_t *attr);
+
+int pthread_mutex_destroy(pthread_mutex_t *mutex);
+
+int pthread_mutex_lock(pthread_mutex_t *mutex);
+
+int pthread_mutex_trylock(pthread_mutex_t *mutex);
+
+int pthread_mutex_unlock(pthread_mutex_t *mutex);
+
+int pthread_cond_init(pthread_cond_t *cond, const pthread_condattr_t *attr);
+
+int pthread_cond_destroy(pthread_cond_t *cond);
+
+int pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex);
+
+int pthread_cond_signal(pthread_cond_t *cond);
+
+int pthread_cond_broadcast(pthread_cond_t *cond);
+
+#endif /* _PTHREAD_H_ */
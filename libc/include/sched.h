@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#ifndef _SCHED_H_
+#define _SCHED_H_
+
+#include <sys/types.h>
+#include <unistd.h>
+
+/* Process creation flags */
+#define CLONE_VM        0x00000100  /**< Share the address space */
+#define CLONE_FILES     0x00000400  /**< Share the open files table */
+#define CLONE_SIGHAND   0x00000800  /**< Share the signal handlers */
+#define CLONE_VFORK     0x00004000  /**< Suspend the parent until exec/exit */
+
+/**
+ * Create a child process running fn(arg) on the given stack, sharing with
+ * the caller the resources selected by flags (CLONE_VM, CLONE_FILES,
+ * CLONE_SIGHAND, CLONE_VFORK). The child exits when fn returns.
+ *
+ * @param fn    Child function.
+ * @param stack Top of the child stack.
+ * @param flags Sharing flags.
+ * @param arg   Child function argument.
+ * @return      Child pid or -1 on error (errno is set).
+ */
+int clone(int (*fn)(void *), void *stack, int flags, void *arg);
+
+#endif /* _SCHED_H_ */
@@ -57,7 +57,11 @@
 #define SIGSYS      31
 #define SIGUNUSED   SIGSYS
 
-#define NSIG        (SIGUNUSED + 1)
+/* Real-time signals, queued and delivered lowest number first */
+#define SIGRTMIN    32
+#define SIGRTMAX    63
+
+#define NSIG        (SIGRTMAX + 1)
 
 typedef int sig_atomic_t;
 
@@ -67,7 +71,8 @@ typedef void (*sighandler_t)(int);
 #define SIG_DFL ((sighandler_t) 0)
 #define SIG_IGN ((sighandler_t) 1)
 
-typedef unsigned long sigset_t;
+/** Signals set, bit n is signal n (bit 0 is unused). */
+typedef unsigned long long sigset_t;
 
 #define sigemptyset(set) \
     (*(set) = 0)
@@ -76,23 +81,40 @@ typedef unsigned long sigset_t;
     ((*(set) = ~(sigset_t)0), 0)
 
 #define sigaddset(set, n) \
-    ((0 < (n) && (n) < NSIG) ? ((*(set) |= (1 << (n))), 0) : -1)
+    ((0 < (n) && (n) < NSIG) ? ((*(set) |= ((sigset_t)1 << (n))), 0) : -1)
 
 #define sigdelset(set, n) \
-    ((0 < (n) && (n) < NSIG) ? ((*(set) &= ~(1 << (n))), 0) : -1)
+    ((0 < (n) && (n) < NSIG) ? ((*(set) &= ~((sigset_t)1 << (n))), 0) : -1)
 
 #define sigismember(set, n) \
-    ((0 < (n) && (n) < NSIG) ? ((*(set) & (1 << (n))) ? 1 : 0) : -1)
+    ((0 < (n) && (n) < NSIG) ? ((*(set) & ((sigset_t)1 << (n))) ? 1 : 0) : -1)
 
 #define sigisemptyset(set) \
     (*(set) == 0)
 
+/** Signal value, passed by sigqueue. */
+union sigval {
+    int     sival_int;
+    void    *sival_ptr;
+};
+
 typedef struct siginfo {
-    int si_signo;
-    int si_errno;
-    int si_code;
+    int             si_signo;   /**< Signal number */
+    int             si_errno;   /**< Error number (unused) */
+    int             si_code;    /**< Signal source (SI_*) */
+    pid_t           si_pid;     /**< Sending process */
+    uid_t           si_uid;     /**< Sending process real user ID */
+    union sigval    si_value;   /**< Signal value */
 } siginfo_t;
 
+/* Signal codes */
+#define SI_USER         0       /**< Sent by kill or raise */
+#define SI_KERNEL       0x80    /**< Sent by the kernel */
+#define SI_QUEUE        (-1)    /**< Sent by sigqueue */
+
+/* Signal action flags */
+#define SA_SIGINFO      0x00000004  /**< Handler takes three arguments */
+
 struct sigaction {
     union {
         void (*sa_handler)(int);
@@ -123,4 +145,13 @@ int sigprocmask(int how, const sigset_t *set, sigset_t *oset);
 
 int sigsuspend(const sigset_t *mask);
 
+int sigqueue(pid_t pid, int sig, const union sigval value);
+
+int sigwaitinfo(const sigset_t *set, siginfo_t *info);
+
+struct timespec;
+
+int sigtimedwait(const sigset_t *set, siginfo_t *info,
+                 const struct timespec *timeout);
+
 #endif /* _SIGNAL_H_ */
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#ifndef _SPAWN_H_
+#define _SPAWN_H_
+
+#include <sys/types.h>
+#include <signal.h>
+
+/* posix_spawnattr_t flags */
+#define POSIX_SPAWN_SETPGROUP   0x01    /**< Set the process group */
+#define POSIX_SPAWN_SETSIGDEF   0x02    /**< Set signals default action */
+#define POSIX_SPAWN_SETSIGMASK  0x04    /**< Set the signal mask */
+#define POSIX_SPAWN_TCSETPGROUP 0x08    /**< Set the terminal foreground group
+                                             (non standard, as in glibc) */
+
+/** Spawn attributes. */
+typedef struct {
+    short       flags;      /** POSIX_SPAWN flags */
+    pid_t       pgroup;     /** Process group (0 to create a new one) */
+    sigset_t    sigdefault; /** Signals reset to the default action */
+    sigset_t    sigmask;    /** Signal mask */
+    int         tcfd;       /** Terminal for POSIX_SPAWN_TCSETPGROUP */
+} posix_spawnattr_t;
+
+/** File action performed in the child before the exec. */
+struct spawn_action {
+    int         type;       /** Action type */
+    int         fd;         /** Target descriptor */
+    int         srcfd;      /** Source descriptor for dup2 */
+    int         oflag;      /** Open flags */
+    mode_t      mode;       /** Open mode */
+    char        *path;      /** Open path (owned copy) */
+};
+
+/** Spawn file actions list. */
+typedef struct {
+    int                 count;      /** Number of actions */
+    int                 size;       /** Allocated actions */
+    struct spawn_action *actions;   /** Actions array */
+} posix_spawn_file_actions_t;
+
+
+int posix_spawn(pid_t *pid, const char *path,
+                const posix_spawn_file_actions_t *file_actions,
+                const posix_spawnattr_t *attrp,
+                char *const argv[], char *const envp[]);
+
+int posix_spawnp(pid_t *pid, const char *file,
+                 const posix_spawn_file_actions_t *file_actions,
+                 const posix_spawnattr_t *attrp,
+                 char *const argv[], char *const envp[]);
+
+int posix_spawn_file_actions_init(posix_spawn_file_actions_t *fact);
+
+int posix_spawn_file_actions_destroy(posix_spawn_file_actions_t *fact);
+
+int posix_spawn_file_actions_addopen(posix_spawn_file_actions_t *fact,
+                                     int fd, const char *path,
+                                     int oflag, mode_t mode);
+
+int posix_spawn_file_actions_addclose(posix_spawn_file_actions_t *fact,
+                                      int fd);
+
+int posix_spawn_file_actions_adddup2(posix_spawn_file_actions_t *fact,
+                                     int fd, int newfd);
+
+int posix_spawnattr_init(posix_spawnattr_t *attr);
+
+int posix_spawnattr_destroy(posix_spawnattr_t *attr);
+
+int posix_spawnattr_getflags(const posix_spawnattr_t *attr, short *flags);
+
+int posix_spawnattr_setflags(posix_spawnattr_t *attr, short flags);
+
+int posix_spawnattr_getpgroup(const posix_spawnattr_t *attr, pid_t *pgroup);
+
+int posix_spawnattr_setpgroup(posix_spawnattr_t *attr, pid_t pgroup);
+
+int posix_spawnattr_getsigdefault(const posix_spawnattr_t *attr,
+                                  sigset_t *sigdefault);
+
+int posix_spawnattr_setsigdefault(posix_spawnattr_t *attr,
+                                  const sigset_t *sigdefault);
+
+int posix_spawnattr_getsigmask(const posix_spawnattr_t *attr,
+                               sigset_t *sigmask);
+
+int posix_spawnattr_setsigmask(posix_spawnattr_t *attr,
+                               const sigset_t *sigmask);
+
+int posix_spawnattr_tcgetpgrp_np(const posix_spawnattr_t *attr, int *fd);
+
+int posix_spawnattr_tcsetpgrp_np(posix_spawnattr_t *attr, int fd);
+
+#endif /* _SPAWN_H_ */
@@ -251,5 +251,11 @@ int pclose(FILE *stream);
  */
 int fileno(FILE *stream);
 
+/**
+ * Rename a file, moving it between directories if required.
+ * An existing destination file is replaced.
+ */
+int rename(const char *oldpath, const char *newpath);
+
 
 #endif /* _STDIO_H_ */
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Event notification descriptor.
+ *
+ * The descriptor holds a 64-bit counter. A write adds the given value to
+ * the counter, a read returns the counter value and resets it, or returns
+ * one and decrements it in semaphore mode. A read of a zero counter blocks
+ * until a write happens.
+ */
+
+#ifndef _SYS_EVENTFD_H_
+#define _SYS_EVENTFD_H_
+
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+typedef uint64_t eventfd_t;
+
+#define EFD_SEMAPHORE   1           /**< Semaphore-like reads */
+#define EFD_NONBLOCK    O_NONBLOCK  /**< Non blocking reads and writes */
+#define EFD_CLOEXEC     O_CLOEXEC   /**< Close on exec */
+
+/**
+ * Create an event notification descriptor.
+ *
+ * @param initval   Counter initial value.
+ * @param flags     EFD_* flags.
+ * @return          The descriptor or -1 on error (errno is set).
+ */
+static inline int eventfd(unsigned int initval, int flags)
+{
+    return syscall(__NR_eventfd, initval, flags);
+}
+
+static inline int eventfd_read(int fd, eventfd_t *value)
+{
+    return (read(fd, value, sizeof(*value)) == sizeof(*value)) ? 0 : -1;
+}
+
+static inline int eventfd_write(int fd, eventfd_t value)
+{
+    return (write(fd, &value, sizeof(value)) == sizeof(value)) ? 0 : -1;
+}
+
+#endif /* _SYS_EVENTFD_H_ */
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Fast user-space locking primitive.
+ *
+ * The lock state lives in a user space word, the kernel is entered only
+ * to sleep while the word holds an expected value or to wake the waiters.
+ */
+
+#ifndef _SYS_FUTEX_H_
+#define _SYS_FUTEX_H_
+
+#include <unistd.h>
+
+#define FUTEX_WAIT      0   /**< Sleep if the word equals the value */
+#define FUTEX_WAKE      1   /**< Wake up to value waiters */
+
+/**
+ * Futex operation.
+ *
+ * @param uaddr Futex word (32-bit aligned).
+ * @param op    Operation (FUTEX_WAIT or FUTEX_WAKE).
+ * @param val   Expected word value (wait) or number of waiters (wake).
+ * @return      Wait: 0 when woken up, -1 with errno EAGAIN if the word did
+ *              not match or EINTR if interrupted by a signal.
+ *              Wake: number of woken up waiters.
+ */
+static inline int futex(int *uaddr, int op, int val)
+{
+    return syscall(__NR_futex, uaddr, op, val);
+}
+
+#endif /* _SYS_FUTEX_H_ */
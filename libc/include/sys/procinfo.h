@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Processes information snapshot (BeeOS specific).
+ */
+
+#ifndef _SYS_PROCINFO_H_
+#define _SYS_PROCINFO_H_
+
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+/** Process command name length, including the terminator. */
+#define PROC_COMM_LEN   16
+
+/** Process information. */
+struct procinfo {
+    pid_t           pid;                    /**< Process ID */
+    pid_t           ppid;                   /**< Parent process ID */
+    pid_t           pgid;                   /**< Process group ID */
+    uid_t           uid;                    /**< Real user ID */
+    char            state;                  /**< 'R', 'S' or 'Z' */
+    char            comm[PROC_COMM_LEN];    /**< Command name */
+    clock_t         utime;                  /**< User CPU ticks */
+    clock_t         stime;                  /**< System CPU ticks */
+    unsigned long   minflt;                 /**< Page faults */
+    unsigned long   nvcsw;                  /**< Voluntary switches */
+    unsigned long   nivcsw;                 /**< Involuntary switches */
+    unsigned long   nsyscalls;              /**< System calls */
+    unsigned long   rchar;                  /**< Bytes read */
+    unsigned long   wchar;                  /**< Bytes written */
+};
+
+/**
+ * Get the information of the live processes.
+ *
+ * @param buf   Processes information array.
+ * @param count Array size.
+ * @return      Number of processes in the system, at most count entries
+ *              are filled.
+ */
+static inline int procinfo(struct procinfo *buf, int count)
+{
+    return syscall(__NR_procinfo, buf, count);
+}
+
+#endif /* _SYS_PROCINFO_H_ */
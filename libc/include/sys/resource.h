@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#ifndef _SYS_RESOURCE_H_
+#define _SYS_RESOURCE_H_
+
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+#define RUSAGE_SELF     0       /**< Calling process */
+#define RUSAGE_CHILDREN (-1)    /**< Terminated and waited for children */
+
+/** Resources usage. */
+struct rusage {
+    struct timeval  ru_utime;       /**< User CPU time */
+    struct timeval  ru_stime;       /**< System CPU time */
+    long            ru_minflt;      /**< Page faults without I/O */
+    long            ru_majflt;      /**< Page faults with I/O */
+    long            ru_nvcsw;       /**< Voluntary context switches */
+    long            ru_nivcsw;      /**< Involuntary context switches */
+    /* BeeOS extensions */
+    long            ru_nsyscalls;   /**< System calls */
+    long            ru_rchar;       /**< Bytes read */
+    long            ru_wchar;       /**< Bytes written */
+};
+
+static inline int getrusage(int who, struct rusage *usage)
+{
+    return syscall(__NR_getrusage, who, usage);
+}
+
+#endif /* _SYS_RESOURCE_H_ */
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Signals notification descriptor.
+ *
+ * Reading the descriptor dequeues the pending signals of the calling
+ * process within the descriptor mask, one record per signal. The signals
+ * should be blocked to prevent their default disposition.
+ */
+
+#ifndef _SYS_SIGNALFD_H_
+#define _SYS_SIGNALFD_H_
+
+#include <stdint.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+
+#define SFD_NONBLOCK    O_NONBLOCK  /**< Non blocking reads */
+#define SFD_CLOEXEC     O_CLOEXEC   /**< Close on exec */
+
+/** Signal record read from the descriptor. */
+struct signalfd_siginfo {
+    uint32_t    ssi_signo;  /**< Signal number */
+    int32_t     ssi_errno;  /**< Error number (unused) */
+    int32_t     ssi_code;   /**< Signal source (SI_*) */
+    uint32_t    ssi_pid;    /**< Sending process */
+    uint32_t    ssi_uid;    /**< Sending process real user ID */
+    int32_t     ssi_int;    /**< Value sent by sigqueue */
+    uint64_t    ssi_ptr;    /**< Value sent by sigqueue */
+    uint8_t     pad[36];    /**< Padding to 64 bytes */
+};
+
+/**
+ * Create a signals notification descriptor or change its mask.
+ *
+ * @param fd        -1 to create a new descriptor, otherwise an existing
+ *                  signalfd descriptor to update.
+ * @param mask      Signals to be read.
+ * @param flags     SFD_* flags.
+ * @return          The descriptor or -1 on error (errno is set).
+ */
+static inline int signalfd(int fd, const sigset_t *mask, int flags)
+{
+    return syscall(__NR_signalfd, fd, mask, flags);
+}
+
+#endif /* _SYS_SIGNALFD_H_ */
@@ -97,4 +97,6 @@ struct stat {
 
 int stat(const char *path, struct stat *buf);
 
+int mkdir(const char *path, mode_t mode);
+
 #endif /* _SYS_STAT_H_ */
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Time page shared between the kernel and the user space.
+ *
+ * The kernel maps a read-only page at TIMEPAGE_ADDR in every process
+ * address space and keeps it updated on every clock tick and on every
+ * context switch. This allows the library to read the time without
+ * entering the kernel.
+ */
+
+#ifndef _SYS_TIMEPAGE_H_
+#define _SYS_TIMEPAGE_H_
+
+#include <stdint.h>
+#include <time.h>
+
+/** Time page user virtual address. */
+#define TIMEPAGE_ADDR       0xBFC00000
+
+/** Value of the magic field once the kernel has initialized the page. */
+#define TIMEPAGE_MAGIC      0x54494D45
+
+struct timepage {
+    uint32_t    magic;      /**< Valid page marker (TIMEPAGE_MAGIC) */
+    uint32_t    seq;        /**< Sequence counter, odd while updating */
+    clock_t     ticks;      /**< Clock ticks since system startup */
+    clock_t     usage;      /**< Running task CPU time at switch */
+    clock_t     switched;   /**< Clock ticks value at the last switch */
+    uint64_t    tsc;        /**< Time stamp counter at the last tick */
+    uint32_t    tsc_mult;   /**< TSC to nanoseconds multiplier (0 if none) */
+    uint32_t    tsc_shift;  /**< TSC to nanoseconds shift */
+};
+
+#endif /* _SYS_TIMEPAGE_H_ */
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#ifndef _SYS_TIMES_H_
+#define _SYS_TIMES_H_
+
+#include <time.h>
+#include <unistd.h>
+
+/** Process times, in clock ticks (CLOCKS_PER_SEC). */
+struct tms {
+    clock_t tms_utime;      /**< User CPU time */
+    clock_t tms_stime;      /**< System CPU time */
+    clock_t tms_cutime;     /**< User CPU time of waited for children */
+    clock_t tms_cstime;     /**< System CPU time of waited for children */
+};
+
+/**
+ * Get the process times.
+ *
+ * @param buf   Filled with the process times.
+ * @return      Clock ticks since system startup.
+ */
+static inline clock_t times(struct tms *buf)
+{
+    return (clock_t)(unsigned int)syscall(__NR_times, buf);
+}
+
+#endif /* _SYS_TIMES_H_ */
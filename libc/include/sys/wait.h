@@ -25,9 +25,30 @@
 
 #define WNOHANG     1   /**< Return immediatelly if no child exited */
 
+/** Child terminated normally. */
+#define WIFEXITED(status)       (((status) & 0x7F) == 0)
+/** Exit code of a normally terminated child. */
+#define WEXITSTATUS(status)     (((status) >> 8) & 0xFF)
+/** Child terminated by a signal. */
+#define WIFSIGNALED(status)     (((status) & 0x7F) != 0)
+/** Signal that terminated the child. */
+#define WTERMSIG(status)        ((status) & 0x7F)
+
 static inline pid_t wait(int *wstatus)
 {
     return waitpid(-1, wstatus, 0);
 }
 
+struct rusage;
+
+/**
+ * Wait for a child like waitpid and get its resources usage, including
+ * the usage of its waited for children.
+ */
+static inline pid_t wait4(pid_t pid, int *wstatus, int options,
+                          struct rusage *usage)
+{
+    return syscall(__NR_wait4, pid, wstatus, options, usage);
+}
+
 #endif /* _SYS_WAIT_H_ */
@@ -28,8 +28,22 @@ struct timespec {
     long    tv_nsec;    /**> Nanoseconds */
 };
 
+struct timeval {
+    time_t  tv_sec;     /**> Seconds */
+    long    tv_usec;    /**> Microseconds */
+};
+
+typedef int clockid_t;
+
 #define CLOCKS_PER_SEC ((clock_t) 100)
 
+/** Clock identifiers. @{ */
+#define CLOCK_MONOTONIC             1   /**< Time since system startup */
+#define CLOCK_PROCESS_CPUTIME_ID    2   /**< Calling process CPU time */
+/** @} */
+
 clock_t clock(void);
 
+int clock_gettime(clockid_t clk_id, struct timespec *ts);
+
 #endif /* _TIME_H_ */
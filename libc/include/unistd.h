@@ -65,6 +65,25 @@
 #define __NR_clock          38
 /* Custom info syscall */
 #define __NR_info           39
+#define __NR_vfork          40
+#define __NR_clone          41
+#define __NR_futex          42
+#define __NR_sigqueue       43
+#define __NR_sigtimedwait   44
+#define __NR_eventfd        45
+#define __NR_signalfd       46
+#define __NR_getrusage      47
+#define __NR_times          48
+#define __NR_wait4          49
+#define __NR_procinfo       50
+#define __NR_unlink         51
+#define __NR_mkdir          52
+#define __NR_rmdir          53
+#define __NR_rename         54
+#define __NR_sync           55
+#define __NR_fsync          56
+#define __NR_ftruncate      57
+#define __NR_getdents       58
 
 
 #define STDIN_FILENO        0
@@ -102,6 +121,13 @@ static inline pid_t fork(void)
     return syscall(__NR_fork);
 }
 
+/**
+ * Create a child process sharing the caller address space.
+ * The caller is suspended until the child calls execve or _exit, the
+ * child must not return from the calling function nor call exit.
+ */
+pid_t vfork(void);
+
 static inline ssize_t read(int fd, void *buf, size_t count)
 {
     return syscall(__NR_read, fd, buf, count);
@@ -225,6 +251,31 @@ static inline int chdir(const char *path)
     return syscall(__NR_chdir, path);
 }
 
+static inline int unlink(const char *pathname)
+{
+    return syscall(__NR_unlink, pathname);
+}
+
+static inline int rmdir(const char *pathname)
+{
+    return syscall(__NR_rmdir, pathname);
+}
+
+static inline void sync(void)
+{
+    syscall(__NR_sync);
+}
+
+static inline int fsync(int fd)
+{
+    return syscall(__NR_fsync, fd);
+}
+
+static inline int ftruncate(int fd, off_t length)
+{
+    return syscall(__NR_ftruncate, fd, length);
+}
+
 
 static inline unsigned int sleep(unsigned int seconds)
 {
@@ -1,3 +1,5 @@
 local_sources := crt0.S \
 				 setjmp.S \
-				 syscall.S
+				 syscall.S \
+				 vfork.S \
+				 clone.S
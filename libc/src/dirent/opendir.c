@@ -18,7 +18,6 @@
  */
 
 #include <dirent.h>
-#include <string.h>
 #include <stddef.h>
 #include <errno.h>
 #include <unistd.h>
@@ -57,7 +56,8 @@ DIR *opendir(const char *name)
     }
 
     dirp->fdn = fdn;
-    memset(&dirp->dent, 0, sizeof(dirp->dent));
+    dirp->pos = 0;
+    dirp->count = 0;
 
     return dirp;
 }
@@ -24,13 +24,21 @@
 
 struct dirent *readdir(DIR *dirp)
 {
+    int n;
+
     if (dirp == NULL || dirp->fdn < 0) {
         errno = EBADF;
         return NULL;
     }
 
-    if (read(dirp->fdn, &dirp->dent, sizeof(dirp->dent)) != sizeof(dirp->dent))
-        return NULL;
+    /* Refill the buffer with as many entries as possible */
+    if (dirp->pos == dirp->count) {
+        n = getdents(dirp->fdn, dirp->dents, sizeof(dirp->dents));
+        if (n <= 0)
+            return NULL;    /* End of directory or errno already set */
+        dirp->count = n / sizeof(struct dirent);
+        dirp->pos = 0;
+    }
 
-    return &dirp->dent;
+    return &dirp->dents[dirp->pos++];
 }
@@ -1,4 +1,6 @@
 local_sources := closedir.c \
 				 DIR.c \
+				 getdents.c \
 				 opendir.c \
-				 readdir.c
+				 readdir.c \
+				 rewinddir.c
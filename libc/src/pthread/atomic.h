@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#ifndef _PTHREAD_ATOMIC_H_
+#define _PTHREAD_ATOMIC_H_
+
+/*
+ * Atomically compare *ptr with old and, if equal, store val.
+ * Returns the previous value.
+ */
+static inline int atomic_cmpxchg(int *ptr, int old, int val)
+{
+    int prev;
+
+    asm volatile("lock cmpxchg %1, %2"
+                 : "=a"(prev), "+m"(*ptr)
+                 : "r"(val), "0"(old)
+                 : "memory");
+    return prev;
+}
+
+/*
+ * Atomically store val in *ptr and return the previous value.
+ */
+static inline int atomic_xchg(int *ptr, int val)
+{
+    asm volatile("xchg %0, %1"
+                 : "+m"(*ptr), "+r"(val)
+                 :
+                 : "memory");
+    return val;
+}
+
+/*
+ * Atomically add val to *ptr and return the previous value.
+ */
+static inline int atomic_fetch_add(int *ptr, int val)
+{
+    asm volatile("lock xadd %0, %1"
+                 : "+m"(*ptr), "+r"(val)
+                 :
+                 : "memory");
+    return val;
+}
+
+#endif /* _PTHREAD_ATOMIC_H_ */
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <errno.h>
+#include <sys/wait.h>
+
+struct pthread {
+    pid_t   tid;                /* Thread process identifier */
+    void    *(*start)(void *);  /* Start routine */
+    void    *arg;               /* Start routine argument */
+    void    *ret;               /* Start routine return value */
+    void    *stack;             /* Stack base */
+};
+
+#define PTHREAD_CLONE_FLAGS (CLONE_VM | CLONE_FILES | CLONE_SIGHAND)
+
+static int thread_start(void *arg)
+{
+    struct pthread *th = arg;
+
+    th->ret = th->start(th->arg);
+    return 0;
+}
+
+int pthread_create(pthread_t *thread, const pthread_attr_t *attr,
+                   void *(*start)(void *), void *arg)
+{
+    struct pthread *th;
+
+    th = malloc(sizeof(*th));
+    if (th == NULL)
+        return EAGAIN;
+    th->stack = malloc(PTHREAD_STACK_SIZE);
+    if (th->stack == NULL) {
+        free(th);
+        return EAGAIN;
+    }
+    th->start = start;
+    th->arg = arg;
+    th->ret = NULL;
+
+    th->tid = clone(thread_start, (char *)th->stack + PTHREAD_STACK_SIZE,
+                    PTHREAD_CLONE_FLAGS, th);
+    if (th->tid < 0) {
+        free(th->stack);
+        free(th);
+        return EAGAIN;
+    }
+    *thread = th;
+    return 0;
+}
+
+int pthread_join(pthread_t thread, void **retval)
+{
+    while (waitpid(thread->tid, NULL, 0) < 0) {
+        if (errno != EINTR)
+            return ESRCH;   /* Not a child of the caller */
+    }
+    if (retval != NULL)
+        *retval = thread->ret;
+    free(thread->stack);
+    free(thread);
+    return 0;
+}
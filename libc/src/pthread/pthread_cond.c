@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Futex based condition variable.
+ * Waiters sleep on the sequence word, which is bumped by every signal
+ * so that a wake up issued between the mutex release and the futex wait
+ * is not lost. Signals issued with no waiters never enter the kernel.
+ */
+
+#include "atomic.h"
+#include <pthread.h>
+#include <sys/futex.h>
+#include <limits.h>
+#include <errno.h>
+
+int pthread_cond_init(pthread_cond_t *cond, const pthread_condattr_t *attr)
+{
+    cond->seq = 0;
+    cond->waiters = 0;
+    return 0;
+}
+
+int pthread_cond_destroy(pthread_cond_t *cond)
+{
+    return (cond->waiters == 0) ? 0 : EBUSY;
+}
+
+int pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex)
+{
+    int seq;
+
+    atomic_fetch_add(&cond->waiters, 1);
+    seq = cond->seq;
+    pthread_mutex_unlock(mutex);
+    futex(&cond->seq, FUTEX_WAIT, seq);
+    atomic_fetch_add(&cond->waiters, -1);
+    pthread_mutex_lock(mutex);
+    return 0;
+}
+
+int pthread_cond_signal(pthread_cond_t *cond)
+{
+    atomic_fetch_add(&cond->seq, 1);
+    if (cond->waiters != 0)
+        futex(&cond->seq, FUTEX_WAKE, 1);
+    return 0;
+}
+
+int pthread_cond_broadcast(pthread_cond_t *cond)
+{
+    atomic_fetch_add(&cond->seq, 1);
+    if (cond->waiters != 0)
+        futex(&cond->seq, FUTEX_WAKE, INT_MAX);
+    return 0;
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Futex based mutex, see "Futexes Are Tricky" (U. Drepper).
+ * The lock word is 0 when unlocked, 1 when locked and 2 when locked with
+ * possible waiters: the kernel is entered only when there is contention.
+ */
+
+#include "atomic.h"
+#include <pthread.h>
+#include <sys/futex.h>
+#include <errno.h>
+
+int pthread_mutex_init(pthread_mutex_t *mutex,
+                       const pthread_mutexattr_t *attr)
+{
+    mutex->lock = 0;
+    return 0;
+}
+
+int pthread_mutex_destroy(pthread_mutex_t *mutex)
+{
+    return (mutex->lock == 0) ? 0 : EBUSY;
+}
+
+int pthread_mutex_lock(pthread_mutex_t *mutex)
+{
+    int c;
+
+    c = atomic_cmpxchg(&mutex->lock, 0, 1);
+    if (c == 0)
+        return 0;   /* Fast path */
+    if (c != 2)
+        c = atomic_xchg(&mutex->lock, 2);
+    while (c != 0) {
+        futex(&mutex->lock, FUTEX_WAIT, 2);
+        c = atomic_xchg(&mutex->lock, 2);
+    }
+    return 0;
+}
+
+int pthread_mutex_trylock(pthread_mutex_t *mutex)
+{
+    return (atomic_cmpxchg(&mutex->lock, 0, 1) == 0) ? 0 : EBUSY;
+}
+
+int pthread_mutex_unlock(pthread_mutex_t *mutex)
+{
+    if (atomic_fetch_add(&mutex->lock, -1) != 1) {
+        /* There may be waiters */
+        mutex->lock = 0;
+        futex(&mutex->lock, FUTEX_WAKE, 1);
+    }
+    return 0;
+}
@@ -0,0 +1,3 @@
+local_sources := pthread.c \
+				 pthread_mutex.c \
+				 pthread_cond.c
@@ -3,4 +3,7 @@ local_sources := sigaction.c \
 				 signal.c \
 				 kill.c \
 				 raise.c \
-				 sigsuspend.c
+				 sigsuspend.c \
+				 sigqueue.c \
+				 sigtimedwait.c \
+				 sigwaitinfo.c
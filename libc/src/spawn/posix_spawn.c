@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "spawn_action.h"
+#include <spawn.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <stddef.h>
+#include <sys/wait.h>
+
+extern char **environ;
+
+/*
+ * Executed by the vfork child: the parent memory is shared, thus only the
+ * child kernel state (descriptors, signals, process group) is modified.
+ */
+static int child_setup(const posix_spawn_file_actions_t *fact,
+                       const posix_spawnattr_t *attr)
+{
+    int i, fd;
+    const struct spawn_action *act;
+    struct sigaction dfl;
+
+    if (attr != NULL) {
+        if ((attr->flags & POSIX_SPAWN_SETPGROUP) != 0 &&
+            setpgid(0, attr->pgroup) < 0)
+            return -1;
+        /* The child owns the terminal before running the new program */
+        if ((attr->flags & POSIX_SPAWN_TCSETPGROUP) != 0 &&
+            tcsetpgrp(attr->tcfd, getpgid(0)) < 0)
+            return -1;
+        if ((attr->flags & POSIX_SPAWN_SETSIGDEF) != 0) {
+            dfl.sa_handler = SIG_DFL;
+            dfl.sa_flags = 0;
+            sigemptyset(&dfl.sa_mask);
+            for (i = 1; i < NSIG; i++) {
+                if (sigismember(&attr->sigdefault, i) > 0 &&
+                    sigaction(i, &dfl, NULL) < 0)
+                    return -1;
+            }
+        }
+        if ((attr->flags & POSIX_SPAWN_SETSIGMASK) != 0 &&
+            sigprocmask(SIG_SETMASK, &attr->sigmask, NULL) < 0)
+            return -1;
+    }
+
+    if (fact == NULL)
+        return 0;
+    for (i = 0; i < fact->count; i++) {
+        act = &fact->actions[i];
+        switch (act->type) {
+        case SPAWN_OPEN:
+            fd = open(act->path, act->oflag, act->mode);
+            if (fd < 0)
+                return -1;
+            if (fd != act->fd) {
+                if (dup2(fd, act->fd) < 0)
+                    return -1;
+                close(fd);
+            }
+            break;
+        case SPAWN_CLOSE:
+            close(act->fd);
+            break;
+        case SPAWN_DUP2:
+            if (dup2(act->srcfd, act->fd) < 0)
+                return -1;
+            break;
+        default:
+            break;
+        }
+    }
+    return 0;
+}
+
+static int spawn(pid_t *pid, const char *path,
+                 const posix_spawn_file_actions_t *fact,
+                 const posix_spawnattr_t *attr,
+                 char *const argv[], char *const envp[], int search)
+{
+    /* Written by the child, shared with the parent */
+    volatile int err = 0;
+    pid_t child;
+
+    if (envp == NULL)
+        envp = environ;
+
+    child = vfork();
+    if (child < 0)
+        return errno;
+    if (child == 0) {
+        if (child_setup(fact, attr) == 0) {
+            if (search != 0)
+                execvpe(path, argv, envp);
+            else
+                execve(path, argv, envp);
+        }
+        err = errno;
+        _exit(127);
+    }
+
+    /* The child has already called execve or _exit */
+    if (err != 0) {
+        waitpid(child, NULL, 0);
+        return err;
+    }
+    if (pid != NULL)
+        *pid = child;
+    return 0;
+}
+
+int posix_spawn(pid_t *pid, const char *path,
+                const posix_spawn_file_actions_t *file_actions,
+                const posix_spawnattr_t *attrp,
+                char *const argv[], char *const envp[])
+{
+    return spawn(pid, path, file_actions, attrp, argv, envp, 0);
+}
+
+int posix_spawnp(pid_t *pid, const char *file,
+                 const posix_spawn_file_actions_t *file_actions,
+                 const posix_spawnattr_t *attrp,
+                 char *const argv[], char *const envp[])
+{
+    return spawn(pid, file, file_actions, attrp, argv, envp, 1);
+}
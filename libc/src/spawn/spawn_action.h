@@ -0,0 +1,28 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#ifndef _SPAWN_SPAWN_ACTION_H_
+#define _SPAWN_SPAWN_ACTION_H_
+
+/* File actions types */
+#define SPAWN_OPEN      1
+#define SPAWN_CLOSE     2
+#define SPAWN_DUP2      3
+
+#endif /* _SPAWN_SPAWN_ACTION_H_ */
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "spawn_action.h"
+#include <spawn.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+
+int posix_spawn_file_actions_init(posix_spawn_file_actions_t *fact)
+{
+    fact->count = 0;
+    fact->size = 0;
+    fact->actions = NULL;
+    return 0;
+}
+
+int posix_spawn_file_actions_destroy(posix_spawn_file_actions_t *fact)
+{
+    int i;
+
+    for (i = 0; i < fact->count; i++)
+        free(fact->actions[i].path);
+    free(fact->actions);
+    return posix_spawn_file_actions_init(fact);
+}
+
+static struct spawn_action *action_add(posix_spawn_file_actions_t *fact,
+                                       int type, int fd)
+{
+    struct spawn_action *act;
+    int size;
+
+    if (fact->count == fact->size) {
+        size = (fact->size != 0) ? 2 * fact->size : 4;
+        act = realloc(fact->actions, size * sizeof(*act));
+        if (act == NULL)
+            return NULL;
+        fact->actions = act;
+        fact->size = size;
+    }
+    act = &fact->actions[fact->count++];
+    memset(act, 0, sizeof(*act));
+    act->type = type;
+    act->fd = fd;
+    return act;
+}
+
+int posix_spawn_file_actions_addopen(posix_spawn_file_actions_t *fact,
+                                     int fd, const char *path,
+                                     int oflag, mode_t mode)
+{
+    struct spawn_action *act;
+    char *copy;
+
+    if (fd < 0 || fd >= OPEN_MAX)
+        return EBADF;
+    copy = strdup(path);
+    if (copy == NULL)
+        return ENOMEM;
+    act = action_add(fact, SPAWN_OPEN, fd);
+    if (act == NULL) {
+        free(copy);
+        return ENOMEM;
+    }
+    act->path = copy;
+    act->oflag = oflag;
+    act->mode = mode;
+    return 0;
+}
+
+int posix_spawn_file_actions_addclose(posix_spawn_file_actions_t *fact,
+                                      int fd)
+{
+    if (fd < 0 || fd >= OPEN_MAX)
+        return EBADF;
+    return (action_add(fact, SPAWN_CLOSE, fd) != NULL) ? 0 : ENOMEM;
+}
+
+int posix_spawn_file_actions_adddup2(posix_spawn_file_actions_t *fact,
+                                     int fd, int newfd)
+{
+    struct spawn_action *act;
+
+    if (fd < 0 || fd >= OPEN_MAX || newfd < 0 || newfd >= OPEN_MAX)
+        return EBADF;
+    act = action_add(fact, SPAWN_DUP2, newfd);
+    if (act == NULL)
+        return ENOMEM;
+    act->srcfd = fd;
+    return 0;
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include <spawn.h>
+#include <errno.h>
+
+#define POSIX_SPAWN_FLAGS   (POSIX_SPAWN_SETPGROUP | \
+                             POSIX_SPAWN_SETSIGDEF | \
+                             POSIX_SPAWN_SETSIGMASK | \
+                             POSIX_SPAWN_TCSETPGROUP)
+
+int posix_spawnattr_init(posix_spawnattr_t *attr)
+{
+    attr->flags = 0;
+    attr->pgroup = 0;
+    sigemptyset(&attr->sigdefault);
+    sigemptyset(&attr->sigmask);
+    attr->tcfd = -1;
+    return 0;
+}
+
+int posix_spawnattr_destroy(posix_spawnattr_t *attr)
+{
+    return 0;
+}
+
+int posix_spawnattr_getflags(const posix_spawnattr_t *attr, short *flags)
+{
+    *flags = attr->flags;
+    return 0;
+}
+
+int posix_spawnattr_setflags(posix_spawnattr_t *attr, short flags)
+{
+    if ((flags & ~POSIX_SPAWN_FLAGS) != 0)
+        return EINVAL;
+    attr->flags = flags;
+    return 0;
+}
+
+int posix_spawnattr_getpgroup(const posix_spawnattr_t *attr, pid_t *pgroup)
+{
+    *pgroup = attr->pgroup;
+    return 0;
+}
+
+int posix_spawnattr_setpgroup(posix_spawnattr_t *attr, pid_t pgroup)
+{
+    attr->pgroup = pgroup;
+    return 0;
+}
+
+int posix_spawnattr_getsigdefault(const posix_spawnattr_t *attr,
+                                  sigset_t *sigdefault)
+{
+    *sigdefault = attr->sigdefault;
+    return 0;
+}
+
+int posix_spawnattr_setsigdefault(posix_spawnattr_t *attr,
+                                  const sigset_t *sigdefault)
+{
+    attr->sigdefault = *sigdefault;
+    return 0;
+}
+
+int posix_spawnattr_getsigmask(const posix_spawnattr_t *attr,
+                               sigset_t *sigmask)
+{
+    *sigmask = attr->sigmask;
+    return 0;
+}
+
+int posix_spawnattr_setsigmask(posix_spawnattr_t *attr,
+                               const sigset_t *sigmask)
+{
+    attr->sigmask = *sigmask;
+    return 0;
+}
+
+int posix_spawnattr_tcgetpgrp_np(const posix_spawnattr_t *attr, int *fd)
+{
+    *fd = attr->tcfd;
+    return 0;
+}
+
+int posix_spawnattr_tcsetpgrp_np(posix_spawnattr_t *attr, int fd)
+{
+    attr->tcfd = fd;
+    return 0;
+}
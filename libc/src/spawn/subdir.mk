@@ -0,0 +1,3 @@
+local_sources := posix_spawn.c \
+				 spawn_file_actions.c \
+				 spawnattr.c
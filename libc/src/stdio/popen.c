@@ -23,6 +23,7 @@
 #include <sys/wait.h>
 #include <stdlib.h>
 #include <limits.h>
+#include <spawn.h>
 
 /* Pointer to array allocated at run-time */
 pid_t *popen_childs = NULL;
@@ -31,10 +32,12 @@ pid_t *popen_childs = NULL;
 
 FILE *popen(const char *command, const char *type)
 {
-    int     i;
+    int     i, err;
     int     pfd[2];
     pid_t   pid;
     FILE    *fp;
+    posix_spawn_file_actions_t fact;
+    char *const argv[] = { "sh", "-c", (char *)command, NULL };
 
     /* only allow "r" or "w" */
     if ((type[0] != 'r' && type[0] != 'w') || type[1] != 0) {
@@ -51,32 +54,35 @@ FILE *popen(const char *command, const char *type)
     if (pipe(pfd) < 0)
         return NULL;    /* errno set by pipe() */
 
-    if ((pid = fork()) < 0) {
-        return NULL;    /* errno set by fork() */
-    } else if (pid == 0) {
-        /* child */
-        if (*type == 'r') {
-            close(pfd[0]);
-            if (pfd[1] != STDOUT_FILENO) {
-                dup2(pfd[1], STDOUT_FILENO);
-                close(pfd[1]);
-            }
-        } else {
-            close(pfd[1]);
-            if (pfd[0] != STDIN_FILENO) {
-                dup2(pfd[0], STDIN_FILENO);
-                close(pfd[0]);
-            }
+    /* Child descriptors setup */
+    posix_spawn_file_actions_init(&fact);
+    if (*type == 'r') {
+        posix_spawn_file_actions_addclose(&fact, pfd[0]);
+        if (pfd[1] != STDOUT_FILENO) {
+            posix_spawn_file_actions_adddup2(&fact, pfd[1], STDOUT_FILENO);
+            posix_spawn_file_actions_addclose(&fact, pfd[1]);
         }
-
-        /* close all descriptors in chldpid[] */
-        for (i = 0; i < OPEN_MAX; i++) {
-            if (popen_childs[i] > 0)
-                close(i);
+    } else {
+        posix_spawn_file_actions_addclose(&fact, pfd[1]);
+        if (pfd[0] != STDIN_FILENO) {
+            posix_spawn_file_actions_adddup2(&fact, pfd[0], STDIN_FILENO);
+            posix_spawn_file_actions_addclose(&fact, pfd[0]);
         }
+    }
 
-        execl("/bin/sh", "sh", "-c", command, NULL);
-        _exit(127);
+    /* close all descriptors in chldpid[] */
+    for (i = 0; i < OPEN_MAX; i++) {
+        if (popen_childs[i] > 0)
+            posix_spawn_file_actions_addclose(&fact, i);
+    }
+
+    err = posix_spawn(&pid, "/bin/sh", &fact, NULL, argv, NULL);
+    posix_spawn_file_actions_destroy(&fact);
+    if (err != 0) {
+        close(pfd[0]);
+        close(pfd[1]);
+        errno = err;
+        return NULL;
     }
 
     /* parent continues... */
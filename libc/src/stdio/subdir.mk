@@ -26,4 +26,5 @@ local_sources := FILE.c \
 				 vfprintf.c \
 				 popen.c \
 				 pclose.c \
-				 fileno.c
+				 fileno.c \
+				 rename.c
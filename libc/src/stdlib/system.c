@@ -19,6 +19,7 @@
 
 #include <unistd.h>
 #include <signal.h>
+#include <spawn.h>
 #include <errno.h>
 #include <stddef.h>
 #include <stdio.h>
@@ -26,9 +27,11 @@
 int system(const char *cmd)
 {
     pid_t pid;
-    int status;
+    int status, err;
     struct sigaction ignore, saveintr, savequit;
-    sigset_t chldmask, savemask;
+    sigset_t chldmask, savemask, sigdef;
+    posix_spawnattr_t attr;
+    char *const argv[] = { "sh", "-c", (char *)cmd, NULL };
 
     if (cmd == NULL) {
         errno = EINVAL;
@@ -50,28 +53,37 @@ int system(const char *cmd)
     if (sigprocmask(SIG_BLOCK, &chldmask, &savemask) < 0)
         return -1;
 
-    if ((pid = fork()) < 0)
-        status = -1;    /* probably out of process */
-
-    if (pid == 0) { /* Child */
-        /* Restore previous signal actions & reset signal mask */
-        sigaction(SIGINT, &saveintr, NULL);
-        sigaction(SIGQUIT, &savequit, NULL);
-        sigprocmask(SIG_SETMASK, &savemask, NULL);
-        execlp("sh", "sh", "-c", cmd, NULL);
-        _exit(127); /* exec error */
-    }
-
     /*
-     * The SIGCHLD is blocked so that we are able to retrive
-     * the status and not be overrun by an eventually SIGCHLD
-     * user handler that, in the worst case, can call the
-     * waitpid beefore us.
+     * The child restores the previous signal mask and the default action
+     * of the signals that were not ignored (exec resets the handlers).
      */
-    while (waitpid(pid, &status, 0) < 0) {
-        if (errno != EINTR) {
-            status = -1;
-            break;
+    (void)sigemptyset(&sigdef);
+    if (saveintr.sa_handler != SIG_IGN)
+        (void)sigaddset(&sigdef, SIGINT);
+    if (savequit.sa_handler != SIG_IGN)
+        (void)sigaddset(&sigdef, SIGQUIT);
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setflags(&attr,
+                             POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK);
+    posix_spawnattr_setsigdefault(&attr, &sigdef);
+    posix_spawnattr_setsigmask(&attr, &savemask);
+
+    err = posix_spawnp(&pid, "sh", NULL, &attr, argv, NULL);
+    posix_spawnattr_destroy(&attr);
+    if (err != 0) {
+        status = 127 << 8;  /* exec error, as from exit(127) */
+    } else {
+        /*
+         * The SIGCHLD is blocked so that we are able to retrive
+         * the status and not be overrun by an eventually SIGCHLD
+         * user handler that, in the worst case, can call the
+         * waitpid beefore us.
+         */
+        while (waitpid(pid, &status, 0) < 0) {
+            if (errno != EINTR) {
+                status = -1;
+                break;
+            }
         }
     }
 
@@ -5,6 +5,8 @@ dirs += dirent \
 		string \
 		unistd \
 		signal \
+		pthread \
+		spawn \
 		sys \
 		stdint \
 		time
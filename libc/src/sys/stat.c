@@ -23,9 +23,11 @@
 
 int stat(const char *path, struct stat *buf)
 {
-    int fd;
+    int fd, res;
 
     if ((fd = open(path, O_RDONLY, 0)) < 0)
         return -1;
-    return fstat(fd, buf);
+    res = fstat(fd, buf);
+    close(fd);
+    return res;
 }
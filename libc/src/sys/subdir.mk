@@ -1 +1 @@
-local_sources := stat.c
+local_sources := stat.c mkdir.c
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include <time.h>
+#include <errno.h>
+#include "timepage.h"
+
+#define TICK_NSECS  (1000000000L / CLOCKS_PER_SEC)
+
+static void ticks_to_timespec(clock_t ticks, long nsec, struct timespec *ts)
+{
+    ts->tv_sec = ticks / CLOCKS_PER_SEC;
+    ts->tv_nsec = (long)(ticks % CLOCKS_PER_SEC) * TICK_NSECS + nsec;
+}
+
+int clock_gettime(clockid_t clk_id, struct timespec *ts)
+{
+    struct timepage tp;
+    uint64_t now;
+    long nsec = 0;
+
+    if (timepage_read(&tp) < 0) {
+        errno = ENOSYS;
+        return -1;
+    }
+
+    switch (clk_id) {
+    case CLOCK_MONOTONIC:
+        /* Interpolate within the current tick using the TSC */
+        if (tp.tsc_mult != 0) {
+            __asm__ volatile("rdtsc" : "=A"(now));
+            now = ((now - tp.tsc) * tp.tsc_mult) >> tp.tsc_shift;
+            nsec = (now < TICK_NSECS) ? (long)now : TICK_NSECS - 1;
+        }
+        ticks_to_timespec(tp.ticks, nsec, ts);
+        break;
+    case CLOCK_PROCESS_CPUTIME_ID:
+        ticks_to_timespec(tp.usage + (tp.ticks - tp.switched), 0, ts);
+        break;
+    default:
+        errno = EINVAL;
+        return -1;
+    }
+    return 0;
+}
@@ -1 +1,2 @@
-local_sources := clock.c
+local_sources := clock.c \
+				 clock_gettime.c
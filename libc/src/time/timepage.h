@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#ifndef _TIME_TIMEPAGE_H_
+#define _TIME_TIMEPAGE_H_
+
+#include <sys/timepage.h>
+
+/*
+ * Take a consistent snapshot of the kernel time page.
+ * The copy is retried if the kernel updated the page in the meantime.
+ * Returns -1 if the page has not been mapped by the kernel.
+ */
+static inline int timepage_read(struct timepage *snap)
+{
+    const volatile struct timepage *tp =
+        (const volatile struct timepage *)TIMEPAGE_ADDR;
+    uint32_t seq;
+
+    if (tp->magic != TIMEPAGE_MAGIC)
+        return -1;
+    do {
+        seq = tp->seq;
+        snap->ticks = tp->ticks;
+        snap->usage = tp->usage;
+        snap->switched = tp->switched;
+        snap->tsc = tp->tsc;
+        snap->tsc_mult = tp->tsc_mult;
+        snap->tsc_shift = tp->tsc_shift;
+    } while ((seq & 1) != 0 || seq != tp->seq);
+    return 0;
+}
+
+#endif /* _TIME_TIMEPAGE_H_ */
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include <sys/stat.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+/* Create the path components one by one, existing ones are skipped */
+static int mkdir_parents(char *path)
+{
+    char *p = path;
+
+    while ((p = strchr(p + 1, '/')) != NULL) {
+        *p = '\0';
+        if (mkdir(path, 0755) < 0 && errno != EEXIST)
+            return -1;
+        *p = '/';
+    }
+    if (mkdir(path, 0755) < 0 && errno != EEXIST)
+        return -1;
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    int i = 1, parents = 0, res = 0;
+
+    if (argc > 1 && strcmp(argv[1], "-p") == 0) {
+        parents = 1;
+        i++;
+    }
+    if (i == argc) {
+        printf("mkdir: usage [-p] dir...\n");
+        return 1;
+    }
+    for (; i < argc; i++) {
+        if ((parents != 0) ? mkdir_parents(argv[i]) : mkdir(argv[i], 0755)) {
+            perror(argv[i]);
+            res = 1;
+        }
+    }
+    return res;
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include <sys/stat.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+
+int main(int argc, char *argv[])
+{
+    struct stat st;
+    const char *base, *p;
+    char dst[PATH_MAX];
+
+    if (argc != 3) {
+        printf("mv: usage source dest\n");
+        return 1;
+    }
+
+    /* Moving into an existing directory keeps the source name */
+    if (stat(argv[2], &st) == 0 && S_ISDIR(st.st_mode)) {
+        for (base = p = argv[1]; *p != '\0'; p++) {
+            if (*p == '/' && p[1] != '\0')
+                base = p + 1;
+        }
+        snprintf(dst, sizeof(dst), "%s/%s", argv[2], base);
+    } else {
+        strncpy(dst, argv[2], sizeof(dst) - 1);
+        dst[sizeof(dst) - 1] = '\0';
+    }
+
+    if (rename(argv[1], dst) < 0) {
+        perror("mv");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/procinfo.h>
+
+#define PROC_MAX    64
+
+static struct procinfo curr[PROC_MAX];
+static struct procinfo prev[PROC_MAX];
+static int prev_num;
+
+void usage()
+{
+    printf("ps: usage [-d secs]\n");
+    exit(1);
+}
+
+/* CPU ticks consumed since the previous sample, or in total if new */
+static unsigned int cpu_delta(const struct procinfo *pi)
+{
+    int i;
+    unsigned int ticks = pi->utime + pi->stime;
+
+    for (i = 0; i < prev_num; i++) {
+        if (prev[i].pid == pi->pid)
+            return ticks - (prev[i].utime + prev[i].stime);
+    }
+    return ticks;
+}
+
+static int snapshot(void)
+{
+    int i, n;
+    const struct procinfo *pi;
+
+    n = procinfo(curr, PROC_MAX);
+    if (n < 0) {
+        perror("procinfo");
+        return -1;
+    }
+    if (n > PROC_MAX)
+        n = PROC_MAX;
+
+    printf("  PID  PPID  PGID S TCK  UTIME  STIME MINFLT    CSW   SYSC"
+           "    RCHAR    WCHAR COMMAND\n");
+    for (i = 0; i < n; i++) {
+        pi = &curr[i];
+        printf("%5d %5d %5d %c %3u %6u %6u %6u %6u %6u %8u %8u %s\n",
+               (int)pi->pid, (int)pi->ppid, (int)pi->pgid, pi->state,
+               cpu_delta(pi),
+               (unsigned int)pi->utime, (unsigned int)pi->stime,
+               (unsigned int)pi->minflt,
+               (unsigned int)(pi->nvcsw + pi->nivcsw),
+               (unsigned int)pi->nsyscalls,
+               (unsigned int)pi->rchar, (unsigned int)pi->wchar,
+               pi->comm);
+    }
+    memcpy(prev, curr, n * sizeof(*curr));
+    prev_num = n;
+    return 0;
+}
+
+/*
+ * Without options prints a single snapshot. With "-d secs" the snapshot
+ * is refreshed every secs seconds (top-like). The TCK column reports the
+ * CPU ticks consumed since the previous refresh, in total at first.
+ */
+int main(int argc, char *argv[])
+{
+    int secs = 0;
+
+    if (argc > 1) {
+        if (strcmp(argv[1], "-d") != 0 || argc != 3)
+            usage();
+        secs = atoi(argv[2]);
+        if (secs <= 0)
+            usage();
+    }
+
+    if (snapshot() < 0)
+        return 1;
+    while (secs != 0) {
+        sleep(secs);
+        printf("\n");
+        if (snapshot() < 0)
+            return 1;
+    }
+    return 0;
+}
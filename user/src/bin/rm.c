@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include <sys/stat.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include <dirent.h>
+#include <limits.h>
+
+/*
+ * Directory entries are read by index, thus after each removal the
+ * directory is scanned again from the start.
+ */
+static int remove_tree(const char *path)
+{
+    struct stat st;
+    struct dirent *dent;
+    DIR *dir;
+    char child[PATH_MAX];
+
+    if (stat(path, &st) < 0)
+        return -1;
+    if (!S_ISDIR(st.st_mode))
+        return unlink(path);
+
+    for (;;) {
+        if ((dir = opendir(path)) == NULL)
+            return -1;
+        while ((dent = readdir(dir)) != NULL) {
+            if (strcmp(dent->d_name, ".") != 0 &&
+                strcmp(dent->d_name, "..") != 0)
+                break;
+        }
+        if (dent != NULL)
+            snprintf(child, sizeof(child), "%s/%s", path, dent->d_name);
+        closedir(dir);
+        if (dent == NULL)
+            break;
+        if (remove_tree(child) < 0)
+            return -1;
+    }
+    return rmdir(path);
+}
+
+int main(int argc, char *argv[])
+{
+    int i = 1, recursive = 0, res = 0;
+
+    if (argc > 1 && strcmp(argv[1], "-r") == 0) {
+        recursive = 1;
+        i++;
+    }
+    if (i == argc) {
+        printf("rm: usage [-r] file...\n");
+        return 1;
+    }
+    for (; i < argc; i++) {
+        if (((recursive != 0) ? remove_tree(argv[i]) : unlink(argv[i])) < 0) {
+            perror(argv[i]);
+            res = 1;
+        }
+    }
+    return res;
+}
@@ -27,6 +27,7 @@
 #include <sys/wait.h>
 #include <signal.h>
 #include <limits.h>
+#include <spawn.h>
 
 #define CMD_MAX 64
 
@@ -94,6 +95,7 @@ static int execute(int argc, char *argv[])
     int status;
     char *cmd;
     int bg = 0;
+    posix_spawnattr_t attr;
 
     cmd = argv[0];
     /* check built-in commands first */
@@ -121,34 +123,34 @@ static int execute(int argc, char *argv[])
         /* Get the previous terminal process group */
         pgrp = tcgetpgrp(STDOUT_FILENO);
 
-        fgpid = pid = fork();
-        if (pid >= 0) {
-            /* Create process group */
-            if (setpgid(pid, pid) >= 0) {
+        /*
+         * The child runs in a new process group with the old mask.
+         * A foreground child also sets the terminal process group itself,
+         * so it owns the terminal even if it runs before the parent.
+         */
+        posix_spawnattr_init(&attr);
+        posix_spawnattr_setflags(&attr,
+                                 POSIX_SPAWN_SETPGROUP |
+                                 POSIX_SPAWN_SETSIGMASK |
+                                 (bg ? 0 : POSIX_SPAWN_TCSETPGROUP));
+        posix_spawnattr_setpgroup(&attr, 0);
+        posix_spawnattr_setsigmask(&attr, &oldmask);
+        posix_spawnattr_tcsetpgrp_np(&attr, STDOUT_FILENO);
+
+        status = posix_spawnp(&pid, cmd, NULL, &attr, argv, environ);
+        posix_spawnattr_destroy(&attr);
+        if (status == 0) {
+            fgpid = pid;
+            if (!bg) {
                 /* Set process group of controlling terminal */
-                if (pid == 0) {
-                    if (!bg) {
-                        tcsetpgrp(STDOUT_FILENO, getpid());
-                    }
-                    status = execvpe(cmd, argv, environ);
-                    if (status < 0) {
-                        printf("sh: %s: %s\n", cmd, strerror(errno));
-                        status = 1;
-                    }
-                    exit(status);
-                } else if (!bg) {
-                    /* Set process group of controlling terminal */
-                    tcsetpgrp(STDOUT_FILENO, pid);
-                    while (!fgterm)
-                        sigsuspend(&zeromask);
-                    tcsetpgrp(STDOUT_FILENO, pgrp);
-                }
-            } else {
-                perror("setpgid error");
-                printf("command runs in parent group\n");
+                tcsetpgrp(STDOUT_FILENO, pid);
+                while (!fgterm)
+                    sigsuspend(&zeromask);
+                tcsetpgrp(STDOUT_FILENO, pgrp);
             }
         } else {
-            perror("fork error");
+            printf("sh: %s: %s\n", cmd, strerror(status));
+            status = 1;
         }
         sigprocmask(SIG_SETMASK, &oldmask, NULL);
     }
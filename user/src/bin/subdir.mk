@@ -4,4 +4,9 @@ local_sources := ls.c \
 				 echo.c \
 				 pwd.c \
 				 kill.c \
-				 env.c
+				 env.c \
+				 ps.c \
+				 mkdir.c \
+				 rmdir.c \
+				 rm.c \
+				 mv.c
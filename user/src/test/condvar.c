@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Producer and consumer threads exchanging items through a bounded
+ * queue protected by a mutex and two condition variables.
+ */
+
+#include <stdio.h>
+#include <pthread.h>
+
+#define QUEUE_SIZE  8
+#define ITEMS       10000
+
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t not_empty = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t not_full = PTHREAD_COND_INITIALIZER;
+static int queue[QUEUE_SIZE];
+static int head, count;
+
+static void *producer(void *arg)
+{
+    int i;
+
+    for (i = 1; i <= ITEMS; i++) {
+        pthread_mutex_lock(&mutex);
+        while (count == QUEUE_SIZE)
+            pthread_cond_wait(&not_full, &mutex);
+        queue[(head + count) % QUEUE_SIZE] = i;
+        count++;
+        pthread_cond_signal(&not_empty);
+        pthread_mutex_unlock(&mutex);
+    }
+    return arg;
+}
+
+int main(void)
+{
+    int i, item, err;
+    long sum = 0;
+    pthread_t th;
+
+    err = pthread_create(&th, NULL, producer, NULL);
+    if (err != 0) {
+        printf("pthread_create error %d\n", err);
+        return 1;
+    }
+    for (i = 0; i < ITEMS; i++) {
+        pthread_mutex_lock(&mutex);
+        while (count == 0)
+            pthread_cond_wait(&not_empty, &mutex);
+        item = queue[head];
+        head = (head + 1) % QUEUE_SIZE;
+        count--;
+        pthread_cond_signal(&not_full);
+        pthread_mutex_unlock(&mutex);
+        sum += item;
+    }
+    pthread_join(th, NULL);
+    printf("sum: %ld (expected %ld)\n", sum, (long)ITEMS * (ITEMS + 1) / 2);
+    return (sum == (long)ITEMS * (ITEMS + 1) / 2) ? 0 : 1;
+}
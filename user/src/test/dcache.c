@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+/*
+ * Dentry and inode caches: negative entries must not hide names created
+ * later and reclaimed entries must be read again from the filesystem with
+ * the content written before their reclaim.
+ */
+
+#include <sys/stat.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+#define DIR_PATH    "/dcache"
+#define FILE_PATH   DIR_PATH "/file"
+#define OTHER_PATH  DIR_PATH "/other"
+#define NFILES      300     /* Beyond the unused dentries limit */
+
+#define CHECK(cond, msg) do { \
+    if (!(cond)) { \
+        printf("dcache: %s (errno %d)\n", msg, errno); \
+        return 1; \
+    } \
+} while (0)
+
+static int exists(const char *path)
+{
+    struct stat st;
+
+    return stat(path, &st) == 0;
+}
+
+int main(void)
+{
+    int fd, i;
+    char path[32];
+    char data[32];
+
+    CHECK(mkdir(DIR_PATH, 0755) == 0, "mkdir");
+
+    /* Repeated misses, as done by the PATH probing */
+    for (i = 0; i < 3; i++)
+        CHECK(!exists(FILE_PATH) && errno == ENOENT, "missing");
+
+    fd = open(FILE_PATH, O_WRONLY | O_CREAT | O_EXCL, 0644);
+    CHECK(fd >= 0, "create after miss");
+    close(fd);
+    CHECK(exists(FILE_PATH), "created");
+
+    CHECK(!exists(OTHER_PATH), "other missing");
+    CHECK(rename(FILE_PATH, OTHER_PATH) == 0, "rename");
+    CHECK(exists(OTHER_PATH), "renamed");
+    CHECK(!exists(FILE_PATH), "old name");
+
+    CHECK(unlink(OTHER_PATH) == 0, "unlink");
+    CHECK(!exists(OTHER_PATH), "unlinked");
+    CHECK(mkdir(OTHER_PATH, 0755) == 0, "mkdir after unlink");
+    CHECK(exists(OTHER_PATH), "mkdir visible");
+    CHECK(rmdir(OTHER_PATH) == 0, "rmdir");
+
+    /* Fill the cache to force the reclamation of the unused entries */
+    for (i = 0; i < NFILES; i++) {
+        snprintf(path, sizeof(path), DIR_PATH "/f%d", i);
+        fd = open(path, O_WRONLY | O_CREAT, 0644);
+        CHECK(fd >= 0, "create many");
+        CHECK(write(fd, path, strlen(path)) == (ssize_t)strlen(path),
+              "write many");
+        close(fd);
+    }
+    for (i = 0; i < NFILES; i++) {
+        snprintf(path, sizeof(path), DIR_PATH "/f%d", i);
+        fd = open(path, O_RDONLY, 0);
+        CHECK(fd >= 0, "lookup after reclaim");
+        memset(data, 0, sizeof(data));
+        CHECK(read(fd, data, sizeof(data)) == (ssize_t)strlen(path) &&
+              strcmp(data, path) == 0, "content after reclaim");
+        close(fd);
+        CHECK(unlink(path) == 0, "unlink many");
+    }
+
+    CHECK(rmdir(DIR_PATH) == 0, "rmdir dir");
+    CHECK(!exists(DIR_PATH), "removed");
+
+    printf("dcache: ok\n");
+    return 0;
+}
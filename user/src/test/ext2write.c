@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Ext2 write support: file creation, writes spanning the indirect blocks,
+ * truncation, append, interleaved appenders (delayed allocation), rename
+ * and removal of files and directories, also while still open.
+ */
+
+#include <sys/stat.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+#define DIR_PATH    "/ext2w"
+#define SUB_PATH    DIR_PATH "/sub"
+#define FILE_PATH   DIR_PATH "/file"
+#define MOVED_PATH  SUB_PATH "/moved"
+#define LOG1_PATH   SUB_PATH "/log1"
+#define LOG2_PATH   SUB_PATH "/log2"
+#define LOG_SIZE    (64 * 1024)
+#define BIG_SIZE    (300 * 1024)    /* Beyond the single indirect blocks */
+#define CHUNK       1000
+
+static char buf[4096];
+
+#define CHECK(cond, msg) do { \
+    if (!(cond)) { \
+        printf("ext2write: %s (errno %d)\n", msg, errno); \
+        return 1; \
+    } \
+} while (0)
+
+static unsigned char pattern(size_t off)
+{
+    return (unsigned char)(off * 31 + off / 4096);
+}
+
+static int write_pattern(int fd, size_t off, size_t size)
+{
+    size_t i, n;
+
+    for (; size > 0; off += n, size -= n) {
+        n = (size < CHUNK) ? size : CHUNK;
+        for (i = 0; i < n; i++)
+            buf[i] = pattern(off + i);
+        if (write(fd, buf, n) != (ssize_t)n)
+            return -1;
+    }
+    return 0;
+}
+
+static int check_pattern(int fd, size_t off, size_t size)
+{
+    ssize_t i, n;
+
+    if (lseek(fd, off, SEEK_SET) != (off_t)off)
+        return -1;
+    for (; size > 0; off += n, size -= n) {
+        n = read(fd, buf, (size < sizeof(buf)) ? size : sizeof(buf));
+        if (n <= 0)
+            return -1;
+        for (i = 0; i < n; i++) {
+            if ((unsigned char)buf[i] != pattern(off + i))
+                return -1;
+        }
+    }
+    return 0;
+}
+
+static int file_size(const char *path)
+{
+    struct stat st;
+
+    return (stat(path, &st) < 0) ? -1 : (int)st.st_size;
+}
+
+/* Two files growing together, as written by concurrent loggers */
+static int interleaved(void)
+{
+    int fd1, fd2, res = -1;
+    size_t off;
+
+    fd1 = open(LOG1_PATH, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    fd2 = open(LOG2_PATH, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd1 < 0 || fd2 < 0)
+        return -1;
+    for (off = 0; off < LOG_SIZE; off += 512) {
+        if (write_pattern(fd1, off, 512) < 0 ||
+            write_pattern(fd2, off, 512) < 0)
+            goto out;
+    }
+    if (fsync(fd1) < 0 || fsync(fd2) < 0)
+        goto out;
+    close(fd1);
+    close(fd2);
+
+    fd1 = open(LOG1_PATH, O_RDONLY, 0);
+    fd2 = open(LOG2_PATH, O_RDONLY, 0);
+    if (fd1 >= 0 && fd2 >= 0 && check_pattern(fd1, 0, LOG_SIZE) == 0 &&
+        check_pattern(fd2, 0, LOG_SIZE) == 0)
+        res = 0;
+out:
+    close(fd1);
+    close(fd2);
+    if (unlink(LOG1_PATH) < 0 || unlink(LOG2_PATH) < 0)
+        res = -1;
+    return res;
+}
+
+int main(void)
+{
+    int fd;
+    size_t i;
+
+    CHECK(mkdir(DIR_PATH, 0755) == 0, "mkdir");
+    CHECK(mkdir(DIR_PATH, 0755) < 0 && errno == EEXIST, "mkdir exists");
+    CHECK(mkdir(SUB_PATH, 0755) == 0, "mkdir sub");
+
+    /* Create and fill a file crossing the indirect blocks */
+    fd = open(FILE_PATH, O_WRONLY | O_CREAT | O_EXCL, 0644);
+    CHECK(fd >= 0, "create");
+    CHECK(write_pattern(fd, 0, BIG_SIZE) == 0, "write");
+    close(fd);
+    CHECK(open(FILE_PATH, O_WRONLY | O_CREAT | O_EXCL, 0644) < 0 &&
+          errno == EEXIST, "exclusive create");
+    CHECK(file_size(FILE_PATH) == BIG_SIZE, "size after write");
+
+    fd = open(FILE_PATH, O_RDONLY, 0);
+    CHECK(fd >= 0, "open");
+    CHECK(check_pattern(fd, 0, BIG_SIZE) == 0, "read back");
+    CHECK(write(fd, buf, 1) < 0 && errno == EBADF, "write on read-only");
+    close(fd);
+
+    /* Shrink, then grow leaving a hole that must read as zeros */
+    fd = open(FILE_PATH, O_RDWR, 0);
+    CHECK(fd >= 0, "open rw");
+    CHECK(ftruncate(fd, 5000) == 0, "truncate");
+    CHECK(file_size(FILE_PATH) == 5000, "size after truncate");
+    CHECK(lseek(fd, 8000, SEEK_SET) == 8000, "seek");
+    CHECK(write_pattern(fd, 8000, 100) == 0, "write after hole");
+    CHECK(check_pattern(fd, 0, 5000) == 0, "content after truncate");
+    CHECK(lseek(fd, 5000, SEEK_SET) == 5000, "seek hole");
+    CHECK(read(fd, buf, 3000) == 3000, "read hole");
+    for (i = 0; i < 3000; i++)
+        CHECK(buf[i] == 0, "hole content");
+    CHECK(check_pattern(fd, 8000, 100) == 0, "content after hole");
+    close(fd);
+
+    /* Append mode writes at the end regardless of the offset */
+    fd = open(FILE_PATH, O_WRONLY | O_APPEND, 0);
+    CHECK(fd >= 0, "open append");
+    CHECK(write_pattern(fd, 8100, 900) == 0, "append");
+    close(fd);
+    CHECK(file_size(FILE_PATH) == 9000, "size after append");
+
+    /* Truncate on open */
+    fd = open(FILE_PATH, O_WRONLY | O_TRUNC, 0);
+    CHECK(fd >= 0, "open truncate");
+    CHECK(write_pattern(fd, 0, 2000) == 0, "write after truncate");
+    close(fd);
+    CHECK(file_size(FILE_PATH) == 2000, "size after open truncate");
+
+    CHECK(interleaved() == 0, "interleaved appenders");
+
+    /* Move into the subdirectory */
+    CHECK(rename(FILE_PATH, MOVED_PATH) == 0, "rename");
+    CHECK(open(FILE_PATH, O_RDONLY, 0) < 0 && errno == ENOENT, "old name");
+    fd = open(MOVED_PATH, O_RDONLY, 0);
+    CHECK(fd >= 0, "open moved");
+    CHECK(check_pattern(fd, 0, 2000) == 0, "moved content");
+    close(fd);
+    CHECK(rename(DIR_PATH, SUB_PATH "/loop") < 0 && errno == EINVAL,
+          "rename into itself");
+
+    /* Removal */
+    CHECK(rmdir(SUB_PATH) < 0 && errno == ENOTEMPTY, "rmdir not empty");
+    CHECK(unlink(SUB_PATH) < 0 && errno == EISDIR, "unlink dir");
+    CHECK(rmdir(MOVED_PATH) < 0 && errno == ENOTDIR, "rmdir file");
+    /* An unlinked file stays usable through the open descriptor */
+    fd = open(MOVED_PATH, O_RDWR, 0);
+    CHECK(fd >= 0, "open before unlink");
+    CHECK(unlink(MOVED_PATH) == 0, "unlink");
+    CHECK(open(MOVED_PATH, O_RDONLY, 0) < 0 && errno == ENOENT, "unlinked");
+    CHECK(check_pattern(fd, 0, 2000) == 0, "content after unlink");
+    CHECK(write_pattern(fd, 2000, 3000) == 0, "write after unlink");
+    CHECK(ftruncate(fd, 4000) == 0, "truncate after unlink");
+    CHECK(check_pattern(fd, 0, 4000) == 0, "content after truncate");
+    close(fd);
+    CHECK(rmdir(SUB_PATH) == 0, "rmdir sub");
+    CHECK(rmdir(DIR_PATH) == 0, "rmdir");
+    CHECK(open(DIR_PATH, O_RDONLY, 0) < 0 && errno == ENOENT, "removed");
+
+    sync();
+    printf("ext2write: ok\n");
+    return 0;
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * File descriptors table growth beyond OPEN_MAX and lowest free
+ * descriptor allocation.
+ */
+
+#include <unistd.h>
+#include <stdio.h>
+#include <limits.h>
+#include <sys/wait.h>
+
+#define FDS     (4 * OPEN_MAX)
+
+int main(void)
+{
+    int i, fd, status;
+    pid_t pid;
+
+    for (i = 0; i < FDS; i++) {
+        fd = dup(STDOUT_FILENO);
+        if (fd < 0) {
+            printf("dup error after %d descriptors\n", i);
+            return 1;
+        }
+    }
+    printf("last descriptor: %d\n", fd);
+
+    /* The lowest free descriptor is reused */
+    close(10);
+    close(5);
+    if ((fd = dup(STDOUT_FILENO)) != 5) {
+        printf("expected descriptor 5, got %d\n", fd);
+        return 1;
+    }
+    if (dup2(STDOUT_FILENO, 2 * FDS) != 2 * FDS) {
+        printf("dup2 error\n");
+        return 1;
+    }
+
+    /* The child gets a copy of the whole table */
+    if ((pid = fork()) < 0) {
+        printf("fork error\n");
+        return 1;
+    }
+    if (pid == 0) {
+        if (write(2 * FDS, "child: ok\n", 10) != 10)
+            return 1;
+        return 0;
+    }
+    waitpid(pid, &status, 0);
+    printf("child status: %d\n", WEXITSTATUS(status));
+    return WEXITSTATUS(status);
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * File reads through the page cache: sequential reads with different
+ * chunk sizes and random reads must return the same content.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define FILE_PATH   "/bin/sh"
+#define CHUNK_MAX   5000
+
+static char buf[CHUNK_MAX];
+
+static int checksum(int fd, size_t chunk, unsigned int *sum, size_t *size)
+{
+    ssize_t i, n;
+
+    *sum = 0;
+    *size = 0;
+    if (lseek(fd, 0, SEEK_SET) != 0)
+        return -1;
+    while ((n = read(fd, buf, chunk)) > 0) {
+        for (i = 0; i < n; i++)
+            *sum = (*sum << 1 | *sum >> 31) ^ (unsigned char)buf[i];
+        *size += n;
+    }
+    return (int)n;
+}
+
+int main(void)
+{
+    static const size_t chunks[] = { 1, 100, 512, 4096, CHUNK_MAX };
+    unsigned int sum, ref_sum = 0;
+    size_t i, size, ref_size = 0, off;
+    int fd;
+    char c;
+
+    fd = open(FILE_PATH, O_RDONLY, 0);
+    if (fd < 0) {
+        printf("open error\n");
+        return 1;
+    }
+
+    for (i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++) {
+        if (checksum(fd, chunks[i], &sum, &size) < 0) {
+            printf("read error\n");
+            return 1;
+        }
+        if (i == 0) {
+            ref_sum = sum;
+            ref_size = size;
+        } else if (sum != ref_sum || size != ref_size) {
+            printf("checksum mismatch with chunk %u\n", (unsigned int)chunks[i]);
+            return 1;
+        }
+    }
+
+    /* Random accesses, compared with a sequential scan */
+    for (i = 0; i < 64; i++) {
+        off = (i * 7919) % ref_size;
+        if (lseek(fd, off, SEEK_SET) != (off_t)off || read(fd, &c, 1) != 1) {
+            printf("random read error\n");
+            return 1;
+        }
+        lseek(fd, off - off % 4096, SEEK_SET);
+        if (read(fd, buf, 4096) <= 0 || buf[off % 4096] != c) {
+            printf("random read mismatch at %u\n", (unsigned int)off);
+            return 1;
+        }
+    }
+    close(fd);
+
+    printf("size %u, checksum %x\n", (unsigned int)ref_size, ref_sum);
+    printf("fileread: ok\n");
+    return 0;
+}
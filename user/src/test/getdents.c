@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+/*
+ * Directory listing: a directory spanning multiple blocks is read back
+ * with getdents using buffers of different sizes and with the buffered
+ * readdir.
+ */
+
+#include <sys/stat.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <errno.h>
+
+#define DIR_PATH    "/getdents"
+#define NFILES      200     /* Some blocks of entries */
+
+static struct dirent dents[16];
+static char seen[NFILES];
+
+#define CHECK(cond, msg) do { \
+    if (!(cond)) { \
+        printf("getdents: %s (errno %d)\n", msg, errno); \
+        return 1; \
+    } \
+} while (0)
+
+/* Count the directory entries reading at most max entries per call */
+static int list(size_t max)
+{
+    int fd, n, i, total = 0;
+
+    memset(seen, 0, sizeof(seen));
+    fd = open(DIR_PATH, O_RDONLY, 0);
+    if (fd < 0)
+        return -1;
+    while ((n = getdents(fd, dents, max * sizeof(struct dirent))) > 0) {
+        for (i = 0; i < n / (int)sizeof(struct dirent); i++) {
+            if (dents[i].d_name[0] == 'f') {
+                if (seen[atoi(&dents[i].d_name[1])]++ != 0)
+                    total = -1000;  /* Duplicated entry */
+            }
+            total++;
+        }
+    }
+    close(fd);
+    return (n < 0) ? -1 : total;
+}
+
+/* Count the directory entries twice with readdir, rewinding in between */
+static int list_readdir(void)
+{
+    DIR *dir;
+    int i, total[2];
+
+    dir = opendir(DIR_PATH);
+    if (dir == NULL)
+        return -1;
+    for (i = 0; i < 2; i++) {
+        total[i] = 0;
+        while (readdir(dir) != NULL)
+            total[i]++;
+        rewinddir(dir);
+    }
+    closedir(dir);
+    return (total[0] == total[1]) ? total[0] : -1;
+}
+
+int main(void)
+{
+    int fd, i;
+    char path[32];
+
+    CHECK(mkdir(DIR_PATH, 0755) == 0, "mkdir");
+    for (i = 0; i < NFILES; i++) {
+        snprintf(path, sizeof(path), DIR_PATH "/f%d", i);
+        fd = open(path, O_WRONLY | O_CREAT, 0644);
+        CHECK(fd >= 0, "create");
+        close(fd);
+    }
+
+    CHECK(list(1) == NFILES + 2, "list one by one");
+    CHECK(list(7) == NFILES + 2, "list by seven");
+    CHECK(list(16) == NFILES + 2, "list by sixteen");
+    CHECK(list_readdir() == NFILES + 2, "readdir");
+
+    /* Entries removed from the middle are not listed */
+    for (i = 0; i < NFILES; i += 2) {
+        snprintf(path, sizeof(path), DIR_PATH "/f%d", i);
+        CHECK(unlink(path) == 0, "unlink");
+    }
+    CHECK(list(16) == NFILES / 2 + 2, "list after unlink");
+
+    fd = open(DIR_PATH, O_RDONLY, 0);
+    CHECK(fd >= 0, "open");
+    CHECK(getdents(fd, dents, 1) < 0 && errno == EINVAL, "small buffer");
+    close(fd);
+    CHECK(getdents(0, dents, sizeof(dents)) < 0 && errno == ENOTDIR,
+          "not a directory");
+
+    for (i = 1; i < NFILES; i += 2) {
+        snprintf(path, sizeof(path), DIR_PATH "/f%d", i);
+        CHECK(unlink(path) == 0, "unlink rest");
+    }
+    CHECK(rmdir(DIR_PATH) == 0, "rmdir");
+
+    printf("getdents: ok\n");
+    return 0;
+}
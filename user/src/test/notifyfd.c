@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Notifications through eventfd and signalfd descriptors.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#include <sys/wait.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+
+#define EVENTS  10
+
+static int test_eventfd(void)
+{
+    int i, efd, status;
+    eventfd_t val, sum = 0;
+    pid_t pid;
+
+    efd = eventfd(0, 0);
+    if (efd < 0) {
+        printf("eventfd error\n");
+        return 1;
+    }
+    if ((pid = fork()) < 0) {
+        printf("fork error\n");
+        return 1;
+    }
+    if (pid == 0) {
+        for (i = 1; i <= EVENTS; i++)
+            eventfd_write(efd, i);
+        return 0;
+    }
+    /* Reads block until the child writes, values are accumulated */
+    while (sum < EVENTS * (EVENTS + 1) / 2) {
+        if (eventfd_read(efd, &val) < 0) {
+            printf("eventfd read error\n");
+            return 1;
+        }
+        sum += val;
+    }
+    waitpid(pid, &status, 0);
+    close(efd);
+
+    /* Semaphore mode decrements by one, then would block */
+    efd = eventfd(2, EFD_SEMAPHORE | EFD_NONBLOCK);
+    if (eventfd_read(efd, &val) < 0 || val != 1 ||
+        eventfd_read(efd, &val) < 0 || val != 1 ||
+        eventfd_read(efd, &val) == 0 || errno != EAGAIN) {
+        printf("eventfd semaphore error\n");
+        return 1;
+    }
+    close(efd);
+    printf("eventfd: ok\n");
+    return 0;
+}
+
+static int test_signalfd(void)
+{
+    int sfd;
+    sigset_t mask;
+    union sigval val;
+    struct signalfd_siginfo ssi[2];
+
+    sigemptyset(&mask);
+    (void)sigaddset(&mask, SIGUSR1);
+    (void)sigaddset(&mask, SIGRTMIN);
+    sigprocmask(SIG_BLOCK, &mask, NULL);
+
+    sfd = signalfd(-1, &mask, 0);
+    if (sfd < 0) {
+        printf("signalfd error\n");
+        return 1;
+    }
+    kill(getpid(), SIGUSR1);
+    val.sival_int = 42;
+    sigqueue(getpid(), SIGRTMIN, val);
+
+    if (read(sfd, ssi, sizeof(ssi)) != sizeof(ssi) ||
+        ssi[0].ssi_signo != SIGUSR1 || ssi[0].ssi_pid != getpid() ||
+        ssi[1].ssi_signo != SIGRTMIN || ssi[1].ssi_int != 42) {
+        printf("signalfd read error\n");
+        return 1;
+    }
+    close(sfd);
+    printf("signalfd: ok\n");
+    return 0;
+}
+
+int main(void)
+{
+    return test_eventfd() || test_signalfd();
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Real-time signals queueing: values sent with sigqueue are received in
+ * order, lower signal numbers first, and none is lost.
+ */
+
+#include <stdio.h>
+#include <signal.h>
+#include <unistd.h>
+#include <time.h>
+
+#define COUNT   16
+
+static volatile int handled;
+
+static void handler(int sig, siginfo_t *info, void *ctx)
+{
+    if (info->si_signo == sig && info->si_code == SI_QUEUE)
+        handled += info->si_value.sival_int;
+}
+
+int main(void)
+{
+    int i, sig;
+    sigset_t set;
+    siginfo_t info;
+    union sigval val;
+    struct sigaction act;
+    struct timespec ts = { 0, 100000000 };
+    pid_t pid = getpid();
+
+    sigemptyset(&set);
+    (void)sigaddset(&set, SIGRTMIN);
+    (void)sigaddset(&set, SIGRTMIN + 1);
+    sigprocmask(SIG_BLOCK, &set, NULL);
+
+    /* Queue in reverse priority order */
+    for (i = 0; i < COUNT; i++) {
+        val.sival_int = i;
+        if (sigqueue(pid, SIGRTMIN + 1, val) < 0 ||
+            sigqueue(pid, SIGRTMIN, val) < 0) {
+            printf("sigqueue error\n");
+            return 1;
+        }
+    }
+
+    for (i = 0; i < 2 * COUNT; i++) {
+        sig = sigwaitinfo(&set, &info);
+        if (sig != SIGRTMIN + i / COUNT ||
+            info.si_value.sival_int != i % COUNT || info.si_pid != pid) {
+            printf("unexpected signal %d value %d\n", sig,
+                   info.si_value.sival_int);
+            return 1;
+        }
+    }
+    if (sigtimedwait(&set, &info, &ts) >= 0) {
+        printf("sigtimedwait: no signal expected\n");
+        return 1;
+    }
+    printf("sigwaitinfo: %d signals received in order\n", 2 * COUNT);
+
+    /* Handler with information */
+    act.sa_sigaction = handler;
+    act.sa_flags = SA_SIGINFO;
+    sigemptyset(&act.sa_mask);
+    sigaction(SIGRTMIN, &act, NULL);
+    for (i = 1; i <= COUNT; i++) {
+        val.sival_int = i;
+        sigqueue(pid, SIGRTMIN, val);
+    }
+    sigprocmask(SIG_UNBLOCK, &set, NULL);
+    printf("handler: sum %d (expected %d)\n", handled,
+           COUNT * (COUNT + 1) / 2);
+    return (handled == COUNT * (COUNT + 1) / 2) ? 0 : 1;
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Resource accounting through getrusage, times and wait4.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/times.h>
+#include <sys/resource.h>
+
+#define WRITES  16
+
+int main(void)
+{
+    int i, status;
+    pid_t pid;
+    volatile unsigned int spin;
+    struct rusage ru;
+    struct tms tms;
+    char buf[32];
+
+    if ((pid = fork()) < 0) {
+        printf("fork error\n");
+        return 1;
+    }
+    if (pid == 0) {
+        for (spin = 0; spin < 10000000; spin++)
+            ;
+        for (i = 0; i < WRITES; i++)
+            write(STDOUT_FILENO, "", 0);
+        return 0;
+    }
+
+    if (wait4(pid, &status, 0, &ru) != pid) {
+        printf("wait4 error\n");
+        return 1;
+    }
+    printf("child: utime %u.%06u stime %u.%06u syscalls %u csw %u/%u\n",
+           (unsigned int)ru.ru_utime.tv_sec, (unsigned int)ru.ru_utime.tv_usec,
+           (unsigned int)ru.ru_stime.tv_sec, (unsigned int)ru.ru_stime.tv_usec,
+           (unsigned int)ru.ru_nsyscalls,
+           (unsigned int)ru.ru_nvcsw, (unsigned int)ru.ru_nivcsw);
+    if (ru.ru_nsyscalls < WRITES) {
+        printf("wait4 rusage error\n");
+        return 1;
+    }
+
+    /* The reaped child is now accounted to our children usage */
+    if (getrusage(RUSAGE_CHILDREN, &ru) < 0 || ru.ru_nsyscalls < WRITES) {
+        printf("getrusage children error\n");
+        return 1;
+    }
+
+    snprintf(buf, sizeof(buf), "rchar test\n");
+    write(STDOUT_FILENO, buf, 11);
+    if (getrusage(RUSAGE_SELF, &ru) < 0 || ru.ru_wchar < 11) {
+        printf("getrusage self error\n");
+        return 1;
+    }
+
+    if (times(&tms) == (clock_t)-1) {
+        printf("times error\n");
+        return 1;
+    }
+    printf("times: utime %u stime %u cutime %u cstime %u\n",
+           (unsigned int)tms.tms_utime, (unsigned int)tms.tms_stime,
+           (unsigned int)tms.tms_cutime, (unsigned int)tms.tms_cstime);
+    printf("rusage: ok\n");
+    return 0;
+}
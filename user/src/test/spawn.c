@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Compares the process creation latency of fork+exec against posix_spawn
+ * (vfork based) while the parent owns a large, touched, heap.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <spawn.h>
+#include <time.h>
+#include <sys/wait.h>
+
+#define LOOPS       20
+#define HEAP_SIZE   (1024 * 1024)
+
+extern char **environ;
+
+static unsigned int elapsed_us(const struct timespec *t0,
+                               const struct timespec *t1)
+{
+    return (unsigned int)((t1->tv_sec - t0->tv_sec) * 1000000 +
+                          (t1->tv_nsec - t0->tv_nsec) / 1000);
+}
+
+int main(int argc, char *argv[])
+{
+    int i, err;
+    pid_t pid;
+    char *heap;
+    struct timespec t0, t1;
+    char *cargv[] = { argv[0], "child", NULL };
+
+    if (argc > 1)
+        return 0;   /* Spawned child */
+
+    heap = malloc(HEAP_SIZE);
+    if (heap == NULL) {
+        perror("malloc");
+        return 1;
+    }
+    memset(heap, 0xA5, HEAP_SIZE);
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (i = 0; i < LOOPS; i++) {
+        pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            return 1;
+        }
+        if (pid == 0) {
+            execvpe(argv[0], cargv, environ);
+            _exit(127);
+        }
+        waitpid(pid, NULL, 0);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    printf("fork+exec: %u us/proc\n", elapsed_us(&t0, &t1) / LOOPS);
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (i = 0; i < LOOPS; i++) {
+        err = posix_spawnp(&pid, argv[0], NULL, NULL, cargv, environ);
+        if (err != 0) {
+            printf("posix_spawnp: %s\n", strerror(err));
+            return 1;
+        }
+        waitpid(pid, NULL, 0);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    printf("posix_spawn: %u us/proc\n", elapsed_us(&t0, &t1) / LOOPS);
+
+    free(heap);
+    return 0;
+}
@@ -14,6 +14,19 @@ local_sources := dump.c \
 				 serial.c \
 				 initadopt.c \
 				 pgrp.c \
-				 atexit.c
+				 atexit.c \
+				 timepage.c \
+				 sysenter.c \
+				 spawn.c \
+				 threads.c \
+				 condvar.c \
+				 fdtable.c \
+				 rtsignals.c \
+				 notifyfd.c \
+				 rusage.c \
+				 fileread.c \
+				 ext2write.c \
+				 dcache.c \
+				 getdents.c
 
 dirs := cp03 cp08
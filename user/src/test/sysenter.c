@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Compares the per-call cost of the getpid system call entered via the
+ * library (SYSENTER if supported) against the plain int 0x80 trap.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <time.h>
+
+#define LOOPS   100000
+
+static unsigned int elapsed_ns(const struct timespec *t0,
+                               const struct timespec *t1)
+{
+    return (unsigned int)((t1->tv_sec - t0->tv_sec) * 1000000000 +
+                          (t1->tv_nsec - t0->tv_nsec));
+}
+
+static pid_t getpid_int(void)
+{
+    pid_t pid;
+
+    asm volatile("int 0x80" : "=a"(pid) : "a"(__NR_getpid) : "memory");
+    return pid;
+}
+
+int main(void)
+{
+    int i;
+    struct timespec t0, t1;
+
+    if (getpid_int() != getpid()) {
+        printf("getpid mismatch\n");
+        return 1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (i = 0; i < LOOPS; i++)
+        getpid_int();
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    printf("int 0x80 getpid: %u ns/call\n", elapsed_ns(&t0, &t1) / LOOPS);
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (i = 0; i < LOOPS; i++)
+        getpid();
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    printf("library getpid: %u ns/call\n", elapsed_ns(&t0, &t1) / LOOPS);
+    return 0;
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Threads sharing a counter protected by a futex based mutex.
+ */
+
+#include <stdio.h>
+#include <pthread.h>
+
+#define THREADS     4
+#define LOOPS       100000
+
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static volatile int counter;
+
+static void *worker(void *arg)
+{
+    int i;
+
+    for (i = 0; i < LOOPS; i++) {
+        pthread_mutex_lock(&mutex);
+        counter++;
+        pthread_mutex_unlock(&mutex);
+    }
+    return arg;
+}
+
+int main(void)
+{
+    int i, err;
+    void *ret;
+    pthread_t th[THREADS];
+
+    for (i = 0; i < THREADS; i++) {
+        err = pthread_create(&th[i], NULL, worker, (void *)i);
+        if (err != 0) {
+            printf("pthread_create error %d\n", err);
+            return 1;
+        }
+    }
+    for (i = 0; i < THREADS; i++) {
+        err = pthread_join(th[i], &ret);
+        if (err != 0 || (int)ret != i) {
+            printf("pthread_join error %d\n", err);
+            return 1;
+        }
+    }
+    printf("counter: %d (expected %d)\n", counter, THREADS * LOOPS);
+    return (counter == THREADS * LOOPS) ? 0 : 1;
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2015-2018, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Compares the cost of reading the process CPU time via the time page
+ * (library clock) against the plain clock syscall.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <time.h>
+
+#define LOOPS   100000
+
+static unsigned int elapsed_ns(const struct timespec *t0,
+                               const struct timespec *t1)
+{
+    return (unsigned int)((t1->tv_sec - t0->tv_sec) * 1000000000 +
+                          (t1->tv_nsec - t0->tv_nsec));
+}
+
+int main(void)
+{
+    int i;
+    struct timespec t0, t1;
+
+    if (clock_gettime(CLOCK_MONOTONIC, &t0) < 0) {
+        perror("clock_gettime");
+        return 1;
+    }
+    for (i = 0; i < LOOPS; i++)
+        syscall(__NR_clock);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    printf("syscall clock: %u ns/call\n", elapsed_ns(&t0, &t1) / LOOPS);
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (i = 0; i < LOOPS; i++)
+        clock();
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    printf("timepage clock: %u ns/call\n", elapsed_ns(&t0, &t1) / LOOPS);
+
+    printf("cpu time: %u ticks\n", (unsigned int)clock());
+    return 0;
+}